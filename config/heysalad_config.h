@@ -1,8 +1,12 @@
 /**
- * HeySalad T5 Terminal Configuration
- * 
- * Copy this file and fill in your credentials.
+ * @file heysalad_config.h
+ * @brief HeySalad T5 Terminal Configuration
+ *
+ * Credentials below are placeholders. Real ones are provisioned per unit
+ * over serial (see src/hs_cfg.h) or passed as -D defines to a local build.
  * DO NOT commit credentials to version control.
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
  */
 
 #ifndef HEYSALAD_CONFIG_H
@@ -10,20 +14,33 @@
 
 // ============================================
 // WiFi Configuration
+// Factory defaults, override per unit over serial:
+//   cfg set wifi_ssid <ssid> / cfg commit
 // ============================================
+#ifndef WIFI_SSID
 #define WIFI_SSID           "your_wifi_ssid"
+#endif
+
+#ifndef WIFI_PASS
 #define WIFI_PASS           "your_wifi_password"
+#endif
+
 #define WIFI_CONNECT_TIMEOUT_MS  30000
 
 // ============================================
 // Tuya Device Credentials
 // Get these from Tuya IoT Platform: https://iot.tuya.com
 // ============================================
+#ifndef TUYA_DEVICE_ID
 #define TUYA_DEVICE_ID      "your_device_id"
+#endif
+
+#ifndef TUYA_DEVICE_KEY
 #define TUYA_DEVICE_KEY     "your_device_key"
+#endif
 
 // ============================================
-// HeySalad API Endpoints
+// HeySalad API Endpoints (factory defaults)
 // ============================================
 #define HEYSALAD_TUYA_BRIDGE    "https://tuya-bridge.heysalad-o.workers.dev"
 #define HEYSALAD_VOICE_AGENT    "https://voice-agent.heysalad-o.workers.dev"
@@ -36,6 +53,8 @@
 #define AUDIO_BIT_DEPTH     16
 #define AUDIO_CHANNELS      1
 #define AUDIO_BUFFER_SIZE   1024
+#define AUDIO_MIC_VOLUME    80      // Percent
+#define AUDIO_SPK_VOLUME    60
 
 // ============================================
 // Voice Recognition
@@ -48,13 +67,63 @@
 // Payment Configuration
 // ============================================
 #define DEFAULT_CURRENCY    "ZMW"
+#define LOCAL_UTC_OFFSET_MIN 120      // CAT (UTC+2), where "today" starts
+#define CLOCK_VALID_AFTER_S 1704067200  // 2024-01-01, earlier means no SNTP yet
 #define PAYMENT_TIMEOUT_SEC 120  // 2 minutes
 
+// ============================================
+// Power Management
+// ============================================
+#define POWER_IDLE_TIMEOUT_MS   2000
+#define POWER_SLEEP_TIMEOUT_MS  30000
+#define POWER_WAKE_TARGET_MS    100   // Press-to-listen budget
+#define POWER_DTIM_IDLE         1     // Wi-Fi listen interval, beacons
+#define POWER_DTIM_SLEEP        3
+#define POWER_POLL_ACTIVE_MS    10
+#define POWER_POLL_IDLE_MS      100
+#define POWER_POLL_SLEEP_MS     1000
+#define POWER_REPORT_INTERVAL_MS (10 * 60 * 1000)
+
+// Estimated draw per state in mA, only used for the power log
+#define POWER_MA_ACTIVE         120
+#define POWER_MA_IDLE           35
+#define POWER_MA_SLEEP          20    // Same CPU sleep as idle, DTIM 3
+
+// ============================================
+// Telemetry (see src/hs_metrics.h)
+// ============================================
+#define METRICS_INTERVAL_MS     (5 * 60 * 1000)    // Close a batch
+#define METRICS_FLUSH_MS        (30 * 60 * 1000)   // Send alone if nothing carried it
+#define METRICS_BATCH_MAX       256
+
+// ============================================
+// Flash Layout
+// Addresses come from the platform partition table (hs_hal_t.partition).
+// OTA records, config store and ledger share the data partition, in that
+// order
+// ============================================
+#define FLASH_SECTOR_SIZE       0x1000
+
+// OTA Update
+#define HEYSALAD_FW_VERSION     "1.0.0"
+#define OTA_MAX_BOOT_ATTEMPTS   3
+#define OTA_CHECK_INTERVAL_MS   (6 * 60 * 60 * 1000)  // 6 hours
+
+// Runtime configuration store (see src/hs_cfg.h)
+#define CFG_STORE_SECTORS       4
+
+// Transaction ledger (see src/hs_ledger.h)
+#define LEDGER_SECTORS          8     // 32 KB, 512 records
+#define LEDGER_MAX_TXNS         256
+#define LEDGER_RECONCILE_INTERVAL_MS  60000
+#define LEDGER_RECONCILE_BATCH  4     // Status queries per run
+
 // ============================================
 // Hardware Pins (T5AI-Core)
 // ============================================
 #define PIN_USER_BUTTON     29  // P29 - Push-to-talk
 #define PIN_USER_LED        9   // P9 - Status LED
+#define PIN_SPEAKER_EN      28  // P28 - Amplifier enable
 #define PIN_DISPLAY_CS      15  // Optional SPI display
 #define PIN_DISPLAY_DC      16
 #define PIN_DISPLAY_RST     18
@@ -0,0 +1,598 @@
+/**
+ * @file hs_hal_linux.c
+ * @brief HeySalad T5 Terminal - Linux HAL backend
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "hs_hal_linux.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "hs_terminal.h"
+
+#define SIM_EPOCH_S     1767225600      // 2026-01-01 00:00:00 UTC
+#define MIC_BUFFER_MAX  (16000 * 2 * 2) // 2 seconds of 16-bit PCM
+
+// Partition table of the simulated flash
+#define PART_APP_BASE   0x00010000
+#define PART_DL_BASE    0x00090000      // Bootloader download area, like the SDK's
+#define PART_IMG_SIZE   0x00080000
+#define PART_PKG_BASE   0x00110000      // Terminal package slots
+#define PART_PKG_SIZE   (2 * PART_IMG_SIZE)
+#define PART_DATA_BASE  0x00310000
+#define PART_DATA_SIZE  0x000E0000
+#define PART_BOOT_BASE  0x003F0000      // Bootloader request sector
+#define SECTOR_SIZE     0x1000
+
+#define BOOT_MAGIC      0x444C4248      // "HBLD"
+#define BOOT_INSTALL    1
+
+typedef struct {
+    uint32_t magic;
+    uint32_t action;
+    uint32_t size;
+} boot_req_t;
+
+// Single in-flight GET, served from an in-process buffer
+typedef struct {
+    int open;
+    int stalled;                // Link silent, nothing more arrives
+    hs_http_head_t head;
+    const uint8_t *data;
+    size_t len;
+    size_t pos;
+} get_stream_t;
+
+static hs_linux_cfg_t g_cfg;
+static hs_hal_t g_hal;
+static int g_flash_fd = -1;
+
+// Simulated clock, ms since init
+static uint64_t g_sim_ms = 0;
+static uint64_t g_start_ms = 0;
+
+static volatile int g_event = 0;
+static hs_led_t g_led = HS_LED_IDLE;
+static size_t g_played = 0;
+static uint32_t g_resets = 0;
+static char g_ssid[33];
+
+static uint8_t g_mic[MIC_BUFFER_MAX];
+static size_t g_mic_len = 0;
+static int g_mic_on = 0;
+
+static char g_get_url[256];
+static const uint8_t *g_get_data = NULL;
+static size_t g_get_len = 0;
+static size_t g_get_drop = 0;           // Body bytes until the link drops, 0 = never
+static size_t g_get_stall = 0;          // Body bytes until the link goes silent, 0 = never
+static size_t g_get_served = 0;
+static get_stream_t g_get;
+
+static uint64_t mono_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static uint64_t elapsed_ms(void)
+{
+    return g_cfg.realtime ? mono_ms() - g_start_ms : g_sim_ms;
+}
+
+// ============================================
+// Timer
+// ============================================
+
+static uint32_t hal_now_ms(void)
+{
+    return (uint32_t)elapsed_ms();
+}
+
+static uint32_t hal_time_s(void)
+{
+    if (g_cfg.no_sntp) {
+        return (uint32_t)(elapsed_ms() / 1000);
+    }
+    if (g_cfg.realtime) {
+        return (uint32_t)time(NULL);
+    }
+    return SIM_EPOCH_S + (uint32_t)(g_sim_ms / 1000);
+}
+
+static void hal_sleep_ms(uint32_t ms)
+{
+    if (!g_cfg.realtime) {
+        g_sim_ms += ms;
+        return;
+    }
+    struct timespec ts = { ms / 1000, (long)(ms % 1000) * 1000000 };
+    nanosleep(&ts, NULL);
+}
+
+static void hal_wait_event(uint32_t ms)
+{
+    if (!g_cfg.realtime) {
+        if (!g_event) {
+            g_sim_ms += ms;
+        }
+        g_event = 0;
+        return;
+    }
+    // Poll in short slices so an event ends the wait early
+    uint64_t end = mono_ms() + ms;
+    while (!g_event && mono_ms() < end) {
+        hal_sleep_ms(1);
+    }
+    g_event = 0;
+}
+
+static void hal_power(hs_power_state_t state)
+{
+    (void)state;
+}
+
+static void hal_reset(void)
+{
+    g_resets++;
+    fprintf(stderr, "[hal] reset requested\n");
+}
+
+// ============================================
+// GPIO and audio
+// ============================================
+
+static void hal_led(hs_led_t status)
+{
+    g_led = status;
+}
+
+static int hal_audio_start(void)
+{
+    g_mic_on = 1;
+    return 0;
+}
+
+static size_t hal_audio_read(uint8_t *buf, size_t len)
+{
+    size_t n = g_mic_len < len ? g_mic_len : len;
+
+    if (!g_mic_on || n == 0) {
+        return 0;
+    }
+    memcpy(buf, g_mic, n);
+    memmove(g_mic, g_mic + n, g_mic_len - n);
+    g_mic_len -= n;
+    return n;
+}
+
+static void hal_audio_stop(void)
+{
+    g_mic_on = 0;
+}
+
+static void hal_audio_play(const uint8_t *pcm, size_t len)
+{
+    (void)pcm;
+    g_played += len;
+}
+
+// ============================================
+// Network
+// ============================================
+
+static int hal_net_connect(const char *ssid, const char *pass)
+{
+    (void)pass;
+    snprintf(g_ssid, sizeof(g_ssid), "%s", ssid);
+    hs_terminal_link(1);
+    return 0;
+}
+
+static int hal_http_post(const char *url, const char *content_type, const char *const *headers,
+                         const uint8_t *body, size_t body_len,
+                         uint8_t *resp, size_t resp_max, size_t *resp_len)
+{
+    (void)content_type;
+    *resp_len = 0;
+    if (!g_cfg.http) {
+        return -1;
+    }
+    return g_cfg.http(g_cfg.http_arg, url, headers, body, body_len, resp, resp_max, resp_len);
+}
+
+/**
+ * @brief GET from the buffer installed with hs_hal_linux_serve()
+ */
+static void *hal_http_get_open(const char *url, uint32_t offset)
+{
+    hs_http_head_t *head = &g_get.head;
+
+    if (g_get.open) {
+        return NULL;
+    }
+    memset(&g_get, 0, sizeof(g_get));
+
+    if (!g_get_data || strcmp(url, g_get_url) != 0) {
+        head->status = 404;
+    } else if (offset == 0) {
+        head->status = 200;
+        g_get.data = g_get_data;
+        g_get.len = g_get_len;
+    } else if (offset < g_get_len) {
+        head->status = 206;
+        head->has_range = 1;
+        head->range_start = offset;
+        g_get.data = g_get_data;
+        g_get.len = g_get_len;
+        g_get.pos = offset;
+    } else {
+        head->status = 416;
+    }
+    g_get.open = 1;
+    return &g_get;
+}
+
+static int hal_http_get_head(void *stream, hs_http_head_t *head)
+{
+    get_stream_t *st = stream;
+
+    if (st->stalled) {
+        return 1;
+    }
+    *head = st->head;
+    return 0;
+}
+
+/**
+ * @brief Cap n at the bytes left before a scheduled link event
+ *
+ * @return 1 when the event is due now
+ */
+static int link_event(size_t *left, size_t *n)
+{
+    if (*left == 0) {
+        return 0;
+    }
+    if (*left == 1) {
+        *left = 0;
+        return 1;
+    }
+    if (*n > *left - 1) {
+        *n = *left - 1;
+    }
+    *left -= *n;
+    return 0;
+}
+
+static int hal_http_get_read(void *stream, uint8_t *buf, size_t len, size_t *got)
+{
+    get_stream_t *st = stream;
+    size_t n = st->len - st->pos;
+
+    *got = 0;
+    if (n > len) {
+        n = len;
+    }
+    if (st->stalled || link_event(&g_get_stall, &n)) {
+        st->stalled = 1;
+        return 0;
+    }
+    // Closed, the body just ends as it would over HTTP/1.0
+    if (link_event(&g_get_drop, &n) || n == 0) {
+        return -1;
+    }
+    memcpy(buf, st->data + st->pos, n);
+    st->pos += n;
+    g_get_served += n;
+    *got = n;
+    return 0;
+}
+
+static void hal_http_get_close(void *stream)
+{
+    ((get_stream_t *)stream)->open = 0;
+}
+
+// ============================================
+// Storage, NOR flash in a file
+// ============================================
+
+static int flash_check(uint32_t addr, size_t len)
+{
+    return (g_flash_fd < 0 || addr > g_cfg.flash_size || len > g_cfg.flash_size - addr) ? -1 : 0;
+}
+
+static int flash_read(void *ctx, uint32_t addr, uint8_t *buf, size_t len)
+{
+    (void)ctx;
+    if (flash_check(addr, len) != 0) {
+        return -1;
+    }
+    return pread(g_flash_fd, buf, len, addr) == (ssize_t)len ? 0 : -1;
+}
+
+static int flash_write(void *ctx, uint32_t addr, const uint8_t *buf, size_t len)
+{
+    uint8_t cur[256];
+
+    (void)ctx;
+    if (flash_check(addr, len) != 0) {
+        return -1;
+    }
+    while (len > 0) {
+        size_t n = len < sizeof(cur) ? len : sizeof(cur);
+        if (pread(g_flash_fd, cur, n, addr) != (ssize_t)n) {
+            return -1;
+        }
+        // Programming can only clear bits
+        for (size_t i = 0; i < n; i++) {
+            cur[i] &= buf[i];
+        }
+        if (pwrite(g_flash_fd, cur, n, addr) != (ssize_t)n) {
+            return -1;
+        }
+        addr += n;
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static int flash_erase(void *ctx, uint32_t addr, size_t len)
+{
+    uint8_t ff[256];
+
+    (void)ctx;
+    if (flash_check(addr, len) != 0) {
+        return -1;
+    }
+    memset(ff, 0xFF, sizeof(ff));
+    while (len > 0) {
+        size_t n = len < sizeof(ff) ? len : sizeof(ff);
+        if (pwrite(g_flash_fd, ff, n, addr) != (ssize_t)n) {
+            return -1;
+        }
+        addr += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static const hs_flash_ops_t g_flash_ops = {
+    .read = flash_read,
+    .write = flash_write,
+    .erase = flash_erase,
+};
+
+static int hal_partition(hs_part_t part, uint32_t *base, uint32_t *size)
+{
+    static const uint32_t table[HS_PART_MAX][2] = {
+        [HS_PART_APP] = { PART_APP_BASE, PART_IMG_SIZE },
+        [HS_PART_OTA] = { PART_PKG_BASE, PART_PKG_SIZE },
+        [HS_PART_DATA] = { PART_DATA_BASE, PART_DATA_SIZE },
+    };
+
+    if (part >= HS_PART_MAX) {
+        return -1;
+    }
+    *base = table[part][0];
+    *size = table[part][1];
+    return 0;
+}
+
+// ============================================
+// Bootloader, acts on requests at the next init
+// ============================================
+
+static int boot_request(uint32_t action, uint32_t size)
+{
+    boot_req_t req = { BOOT_MAGIC, action, size };
+
+    if (flash_erase(NULL, PART_BOOT_BASE, SECTOR_SIZE) != 0) {
+        return -1;
+    }
+    return flash_write(NULL, PART_BOOT_BASE, (const uint8_t *)&req, sizeof(req));
+}
+
+static int image_copy(uint32_t from, uint32_t to, uint32_t len)
+{
+    uint8_t buf[SECTOR_SIZE];
+
+    for (uint32_t off = 0; off < len; off += SECTOR_SIZE) {
+        if (flash_read(NULL, from + off, buf, sizeof(buf)) != 0 ||
+            flash_erase(NULL, to + off, SECTOR_SIZE) != 0 ||
+            flash_write(NULL, to + off, buf, sizeof(buf)) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Install the downloaded image over the application, like the T5
+ *        bootloader, keeping nothing of the replaced one
+ */
+static void bootloader(void)
+{
+    boot_req_t req;
+
+    if (flash_read(NULL, PART_BOOT_BASE, (uint8_t *)&req, sizeof(req)) != 0 || req.magic != BOOT_MAGIC) {
+        return;
+    }
+    if (req.action == BOOT_INSTALL) {
+        fprintf(stderr, "[hal] bootloader: installing %u bytes\n", (unsigned)req.size);
+        image_copy(PART_DL_BASE, PART_APP_BASE, PART_IMG_SIZE);
+    }
+    flash_erase(NULL, PART_BOOT_BASE, SECTOR_SIZE);
+}
+
+/**
+ * @brief Copy the package into the download area, as tkl_ota_data_process
+ *        does on the T5, and ask for it to be installed
+ */
+static int hal_ota_install(const hs_flash_region_t *pkg, uint32_t size)
+{
+    uint8_t buf[SECTOR_SIZE];
+
+    if (size > PART_IMG_SIZE) {
+        return -1;
+    }
+    for (uint32_t off = 0; off < PART_IMG_SIZE; off += SECTOR_SIZE) {
+        uint32_t n = off < size ? (size - off < SECTOR_SIZE ? size - off : SECTOR_SIZE) : 0;
+
+        memset(buf, 0xFF, sizeof(buf));
+        if ((n > 0 && flash_read(NULL, pkg->base + off, buf, n) != 0) ||
+            flash_erase(NULL, PART_DL_BASE + off, SECTOR_SIZE) != 0 ||
+            flash_write(NULL, PART_DL_BASE + off, buf, sizeof(buf)) != 0) {
+            return -1;
+        }
+    }
+    return boot_request(BOOT_INSTALL, size);
+}
+
+// ============================================
+// Diagnostics
+// ============================================
+
+static void hal_log(hs_log_level_t level, const char *line)
+{
+    static const char tag[] = { 'E', 'I', 'D' };
+    uint64_t t = elapsed_ms();
+
+    if (level == HS_LOG_DEBUG && !g_cfg.verbose) {
+        return;
+    }
+    fprintf(stderr, "[%6u.%03u] %c %s\n", (unsigned)(t / 1000), (unsigned)(t % 1000),
+            tag[level <= HS_LOG_DEBUG ? level : HS_LOG_DEBUG], line);
+}
+
+// ============================================
+// Public API
+// ============================================
+
+const hs_hal_t *hs_hal_linux_init(const hs_linux_cfg_t *cfg)
+{
+    struct stat st;
+
+    g_cfg = *cfg;
+    g_flash_fd = open(cfg->flash_path, O_RDWR | O_CREAT, 0644);
+    if (g_flash_fd < 0 || fstat(g_flash_fd, &st) != 0) {
+        perror(cfg->flash_path);
+        hs_hal_linux_close();
+        return NULL;
+    }
+    // New or short file: the missing part reads as erased
+    if (cfg->flash_size < HS_LINUX_FLASH_SIZE ||
+        ((uint64_t)st.st_size < cfg->flash_size &&
+         flash_erase(NULL, (uint32_t)st.st_size, cfg->flash_size - (uint32_t)st.st_size) != 0)) {
+        hs_hal_linux_close();
+        return NULL;
+    }
+    bootloader();
+
+    g_start_ms = mono_ms();
+    g_event = 0;
+    g_mic_len = 0;
+    g_mic_on = 0;
+    g_get.open = 0;
+
+    memset(&g_hal, 0, sizeof(g_hal));
+    g_hal.led = hal_led;
+    g_hal.now_ms = hal_now_ms;
+    g_hal.time_s = hal_time_s;
+    g_hal.sleep_ms = hal_sleep_ms;
+    g_hal.wait_event = hal_wait_event;
+    g_hal.power = hal_power;
+    g_hal.reset = hal_reset;
+    g_hal.audio_start = hal_audio_start;
+    g_hal.audio_read = hal_audio_read;
+    g_hal.audio_stop = hal_audio_stop;
+    g_hal.audio_play = hal_audio_play;
+    g_hal.net_connect = hal_net_connect;
+    g_hal.http_post = hal_http_post;
+    g_hal.http_get_open = hal_http_get_open;
+    g_hal.http_get_head = hal_http_get_head;
+    g_hal.http_get_read = hal_http_get_read;
+    g_hal.http_get_close = hal_http_get_close;
+    g_hal.flash = &g_flash_ops;
+    g_hal.flash_ctx = NULL;
+    g_hal.partition = hal_partition;
+    g_hal.ota_install = hal_ota_install;
+    g_hal.log = hal_log;
+    g_hal.free_heap = NULL;
+    return &g_hal;
+}
+
+void hs_hal_linux_close(void)
+{
+    if (g_flash_fd >= 0) {
+        close(g_flash_fd);
+        g_flash_fd = -1;
+    }
+}
+
+void hs_hal_linux_event(void)
+{
+    g_event = 1;
+}
+
+void hs_hal_linux_audio_feed(const uint8_t *pcm, size_t len)
+{
+    size_t room = sizeof(g_mic) - g_mic_len;
+    size_t n = len < room ? len : room;
+
+    memcpy(g_mic + g_mic_len, pcm, n);
+    g_mic_len += n;
+}
+
+hs_led_t hs_hal_linux_led(void)
+{
+    return g_led;
+}
+
+size_t hs_hal_linux_played(void)
+{
+    return g_played;
+}
+
+uint32_t hs_hal_linux_resets(void)
+{
+    return g_resets;
+}
+
+const char *hs_hal_linux_ssid(void)
+{
+    return g_ssid;
+}
+
+void hs_hal_linux_serve(const char *url, const uint8_t *data, size_t len)
+{
+    snprintf(g_get_url, sizeof(g_get_url), "%s", url);
+    g_get_data = data;
+    g_get_len = len;
+}
+
+void hs_hal_linux_net_drop(size_t bytes)
+{
+    g_get_drop = bytes + 1;
+}
+
+void hs_hal_linux_net_stall(size_t bytes)
+{
+    g_get_stall = bytes + 1;
+}
+
+size_t hs_hal_linux_served(void)
+{
+    return g_get_served;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file hs_hal_linux.h
+ * @brief HeySalad T5 Terminal - Linux HAL backend
+ *
+ * Runs the terminal core as a normal Linux process. Flash is a file with
+ * NOR semantics (erase to 0xFF, program only clears bits), so records
+ * written by one run are read back by the next. hs_hal_linux_init() also
+ * plays the bootloader: a package handed over with ota_install() is copied
+ * to a download area and installed over the application partition there,
+ * leaving no copy of the old image, as on the T5.
+ *
+ * POSTs go to whatever handler the caller installs, typically a stub
+ * bridge in the same process; GETs are served from a buffer registered
+ * with hs_hal_linux_serve(), with Range support, and end by closing the
+ * connection as HTTP/1.0 does.
+ *
+ * With realtime == 0 the clock is simulated: sleeps and idle waits advance
+ * it instantly, so hours of terminal time run in milliseconds and every
+ * run is deterministic.
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#ifndef HS_HAL_LINUX_H
+#define HS_HAL_LINUX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hs_hal.h"
+
+/**
+ * @brief Serve one POST, same contract as hs_hal_t.http_post
+ */
+typedef int (*hs_linux_http_fn)(void *arg, const char *url, const char *const *headers,
+                                const uint8_t *body, size_t body_len,
+                                uint8_t *resp, size_t resp_max, size_t *resp_len);
+
+#define HS_LINUX_FLASH_SIZE     0x00400000  // 4 MB, covers every partition
+
+typedef struct {
+    const char *flash_path;
+    uint32_t flash_size;        // Whole device, at least HS_LINUX_FLASH_SIZE
+    int realtime;               // 0 for the simulated clock
+    int verbose;                // Also print HS_LOG_DEBUG lines
+    int no_sntp;                // Wall clock counts from 0, as before SNTP
+    hs_linux_http_fn http;
+    void *http_arg;
+} hs_linux_cfg_t;
+
+/**
+ * @brief Open (or create, fully erased) the flash file and build the HAL
+ *
+ * @return HAL to pass to hs_terminal_init(), NULL if the file cannot be used
+ */
+const hs_hal_t *hs_hal_linux_init(const hs_linux_cfg_t *cfg);
+
+/**
+ * @brief Close the flash file, as a power cut would
+ */
+void hs_hal_linux_close(void);
+
+/**
+ * @brief End the current wait_event(), call after hs_terminal_button()
+ */
+void hs_hal_linux_event(void);
+
+/**
+ * @brief Queue PCM for the microphone, consumed while recording
+ */
+void hs_hal_linux_audio_feed(const uint8_t *pcm, size_t len);
+
+/**
+ * @brief Current LED status
+ */
+hs_led_t hs_hal_linux_led(void);
+
+/**
+ * @brief Bytes handed to audio_play() so far
+ */
+size_t hs_hal_linux_played(void);
+
+/**
+ * @brief Number of reset() calls so far
+ */
+uint32_t hs_hal_linux_resets(void);
+
+/**
+ * @brief SSID of the last net_connect()
+ */
+const char *hs_hal_linux_ssid(void);
+
+/**
+ * @brief Serve data for GETs of url, until replaced; data must stay valid
+ */
+void hs_hal_linux_serve(const char *url, const uint8_t *data, size_t len);
+
+/**
+ * @brief Close the GET connection after bytes more body bytes, so the
+ *        body ends early
+ */
+void hs_hal_linux_net_drop(size_t bytes);
+
+/**
+ * @brief Let the GET connection go silent after bytes more body bytes,
+ *        until it is closed
+ */
+void hs_hal_linux_net_stall(size_t bytes);
+
+/**
+ * @brief Body bytes served to GETs so far
+ */
+size_t hs_hal_linux_served(void);
+
+#endif // HS_HAL_LINUX_H
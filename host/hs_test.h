@@ -0,0 +1,32 @@
+/**
+ * @file hs_test.h
+ * @brief HeySalad T5 Terminal - Host test helpers
+ *
+ * Each test program counts failed checks and exits non-zero if any failed:
+ *
+ *   CHECK(hs_ledger_count() == 1, "payment recorded");
+ *   return TEST_RESULT();
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#ifndef HS_TEST_H
+#define HS_TEST_H
+
+#include <stdio.h>
+
+static int g_failed = 0;
+
+#define CHECK(cond, msg)                                            \
+    do {                                                            \
+        if (cond) {                                                 \
+            printf("  ok    %s\n", msg);                            \
+        } else {                                                    \
+            printf("  FAIL  %s (%s:%d)\n", msg, __FILE__, __LINE__);\
+            g_failed++;                                             \
+        }                                                           \
+    } while (0)
+
+#define TEST_RESULT()   (printf("%s\n", g_failed ? "FAILED" : "passed"), g_failed ? 1 : 0)
+
+#endif // HS_TEST_H
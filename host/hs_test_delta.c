@@ -0,0 +1,157 @@
+/**
+ * @file hs_test_delta.c
+ * @brief HeySalad T5 Terminal - HSD1 delta builder for host tests
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#include "hs_test_delta.h"
+
+#include "hs_delta.h"
+#include "hs_flash.h"
+
+#define OPS_MAX         512
+#define LZ_WINDOW_SZ2   10
+#define LZ_LOOKAHEAD_SZ2 5
+
+static uint32_t g_seed = 1;
+
+uint32_t hs_test_rand(void)
+{
+    g_seed = g_seed * 1103515245 + 12345;
+    return g_seed >> 8;
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+// ============================================
+// Delta builder
+// ============================================
+
+typedef struct {
+    uint8_t *out;
+    size_t len;
+    uint8_t acc;
+    int bits;
+} bit_writer_t;
+
+static void put_bits(bit_writer_t *w, uint32_t v, int count)
+{
+    for (int k = count - 1; k >= 0; k--) {
+        w->acc = (uint8_t)((w->acc << 1) | ((v >> k) & 1));
+        if (++w->bits == 8) {
+            w->out[w->len++] = w->acc;
+            w->acc = 0;
+            w->bits = 0;
+        }
+    }
+}
+
+/**
+ * @brief Greedy heatshrink encoder, brute force match search
+ */
+static size_t lz_encode(const uint8_t *in, size_t n, uint8_t *out)
+{
+    bit_writer_t w = { out, 0, 0, 0 };
+    size_t i = 0;
+
+    while (i < n) {
+        size_t best = 0, dist = 0;
+        size_t lo = i > (1u << LZ_WINDOW_SZ2) ? i - (1u << LZ_WINDOW_SZ2) : 0;
+
+        for (size_t j = lo; j < i; j++) {
+            size_t l = 0;
+            while (l < (1u << LZ_LOOKAHEAD_SZ2) && i + l < n && in[j + l] == in[i + l]) {
+                l++;
+            }
+            if (l > best) {
+                best = l;
+                dist = i - j;
+            }
+        }
+        if (best >= 3) {
+            put_bits(&w, 0, 1);
+            put_bits(&w, (uint32_t)(dist - 1), LZ_WINDOW_SZ2);
+            put_bits(&w, (uint32_t)(best - 1), LZ_LOOKAHEAD_SZ2);
+            i += best;
+        } else {
+            put_bits(&w, 1, 1);
+            put_bits(&w, in[i], 8);
+            i++;
+        }
+    }
+    if (w.bits > 0) {
+        put_bits(&w, 0, 8 - w.bits);
+    }
+    return w.len;
+}
+
+static size_t put_ctrl(uint8_t *p, uint32_t diff, uint32_t extra, int32_t seek)
+{
+    put_le32(p, diff);
+    put_le32(p + 4, extra);
+    put_le32(p + 8, (uint32_t)seek);
+    return HS_DELTA_CTRL_SIZE;
+}
+
+size_t hs_test_delta(const uint8_t *old, size_t old_len, uint8_t *img, size_t *img_len, uint8_t *patch)
+{
+    static uint8_t ops[HS_TEST_PATCH_MAX * 2];
+    static uint32_t src[OPS_MAX], len[OPS_MAX], extra[OPS_MAX];
+    size_t n_ops = 0, total = 0, pos = 0, p = 0;
+    size_t target = old_len > 0 ? old_len + old_len / 8 : HS_TEST_FULL_SIZE;
+
+    // Blocks of the old image, a few bytes changed, some new bytes between
+    while (total < target && n_ops < OPS_MAX) {
+        if (old_len > 0) {
+            len[n_ops] = 200 + hs_test_rand() % 700;
+            src[n_ops] = hs_test_rand() % (uint32_t)(old_len - len[n_ops]);
+            extra[n_ops] = hs_test_rand() % 40;
+        } else {
+            len[n_ops] = 0;
+            src[n_ops] = 0;
+            extra[n_ops] = 200 + hs_test_rand() % 700;
+        }
+        total += len[n_ops] + extra[n_ops];
+        n_ops++;
+    }
+
+    // Leading empty op moves old_pos to the first block
+    pos += put_ctrl(&ops[pos], 0, 0, (int32_t)src[0]);
+    for (size_t k = 0; k < n_ops; k++) {
+        int32_t next = k + 1 < n_ops ? (int32_t)src[k + 1] : 0;
+
+        pos += put_ctrl(&ops[pos], len[k], extra[k], next - (int32_t)(src[k] + len[k]));
+        for (uint32_t i = 0; i < len[k]; i++) {
+            uint8_t c = old[src[k] + i];
+            if (hs_test_rand() % 97 == 0) {
+                c ^= (uint8_t)(1 + hs_test_rand() % 255);
+            }
+            img[p++] = c;
+            ops[pos++] = (uint8_t)(c - old[src[k] + i]);
+        }
+        for (uint32_t i = 0; i < extra[k]; i++) {
+            img[p] = (uint8_t)hs_test_rand();
+            ops[pos++] = img[p++];
+        }
+    }
+    *img_len = p;
+
+    patch[0] = 'H';
+    patch[1] = 'S';
+    patch[2] = 'D';
+    patch[3] = '1';
+    patch[4] = LZ_WINDOW_SZ2;
+    patch[5] = LZ_LOOKAHEAD_SZ2;
+    patch[6] = patch[7] = 0;
+    put_le32(&patch[8], (uint32_t)old_len);
+    put_le32(&patch[12], hs_crc32(0, old, old_len));
+    put_le32(&patch[16], (uint32_t)p);
+    put_le32(&patch[20], hs_crc32(0, img, p));
+    return HS_DELTA_HEADER_SIZE + lz_encode(ops, pos, &patch[HS_DELTA_HEADER_SIZE]);
+}
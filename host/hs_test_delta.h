@@ -0,0 +1,37 @@
+/**
+ * @file hs_test_delta.h
+ * @brief HeySalad T5 Terminal - HSD1 delta builder for host tests
+ *
+ * Derives a new image from an old one (copied blocks with a few bytes
+ * edited, fresh bytes between them) and builds the heatshrink compressed
+ * delta that turns one into the other, as the bridge would serve it. With
+ * no old image the delta carries a whole one, the first update of a unit
+ * flashed over USB.
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#ifndef HS_TEST_DELTA_H
+#define HS_TEST_DELTA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HS_TEST_PATCH_MAX   (256 * 1024)
+#define HS_TEST_FULL_SIZE   (64 * 1024)     // Whole image, from no old one
+
+/**
+ * @brief Deterministic pseudo random numbers, shared with the builder
+ */
+uint32_t hs_test_rand(void);
+
+/**
+ * @brief Build img (up to old_len * 9 / 8 + 1 KB) from old, and the patch for it
+ *
+ * With old_len 0 img is fresh bytes, up to HS_TEST_FULL_SIZE + 1 KB.
+ *
+ * @return Patch length, patch must hold HS_TEST_PATCH_MAX bytes
+ */
+size_t hs_test_delta(const uint8_t *old, size_t old_len, uint8_t *img, size_t *img_len, uint8_t *patch);
+
+#endif // HS_TEST_DELTA_H
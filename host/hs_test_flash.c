@@ -0,0 +1,107 @@
+/**
+ * @file hs_test_flash.c
+ * @brief HeySalad T5 Terminal - RAM flash with power cut injection
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#include <string.h>
+
+#include "hs_test_flash.h"
+
+/**
+ * @brief Count one op, returning how much of len it may apply
+ */
+static size_t flash_op(hs_test_flash_t *f, size_t len)
+{
+    if (f->off) {
+        return 0;
+    }
+    if (f->ops++ != f->cut_at) {
+        return len;
+    }
+    f->off = 1;
+    return f->torn ? len / 2 : 0;
+}
+
+static int flash_read(void *ctx, uint32_t addr, uint8_t *buf, size_t len)
+{
+    hs_test_flash_t *f = ctx;
+
+    if (f->off || addr + len > f->size) {
+        return -1;
+    }
+    memcpy(buf, f->mem + addr, len);
+    return 0;
+}
+
+static int flash_write(void *ctx, uint32_t addr, const uint8_t *buf, size_t len)
+{
+    hs_test_flash_t *f = ctx;
+    size_t n = 0;
+
+    if (addr + len > f->size) {
+        return -1;
+    }
+    n = flash_op(f, len);
+    for (size_t i = 0; i < n; i++) {
+        if ((f->mem[addr + i] & buf[i]) != buf[i]) {
+            f->bad_writes++;
+        }
+        f->mem[addr + i] &= buf[i];
+    }
+    return f->off ? -1 : 0;
+}
+
+static int flash_erase(void *ctx, uint32_t addr, size_t len)
+{
+    hs_test_flash_t *f = ctx;
+    size_t n = 0;
+
+    if (addr % f->sector_size || len % f->sector_size || addr + len > f->size) {
+        return -1;
+    }
+    n = flash_op(f, len);
+    memset(f->mem + addr, 0xFF, n);
+    if (n > 0) {
+        for (uint32_t s = addr / f->sector_size;
+             s <= (addr + n - 1) / f->sector_size && s < HS_TEST_FLASH_MAX_SECTORS; s++) {
+            f->erases[s]++;
+        }
+    }
+    return f->off ? -1 : 0;
+}
+
+static const hs_flash_ops_t g_test_flash_ops = {
+    flash_read,
+    flash_write,
+    flash_erase,
+};
+
+void hs_test_flash_init(hs_test_flash_t *f, uint8_t *mem, uint32_t size,
+                        uint32_t sector_size, hs_flash_region_t *region)
+{
+    memset(f, 0, sizeof(*f));
+    memset(mem, 0xFF, size);
+    f->mem = mem;
+    f->size = size;
+    f->sector_size = sector_size;
+    f->cut_at = HS_TEST_FLASH_NEVER;
+
+    region->ops = &g_test_flash_ops;
+    region->ctx = f;
+    region->base = 0;
+    region->size = size;
+    region->sector_size = sector_size;
+}
+
+void hs_test_flash_cut(hs_test_flash_t *f, uint32_t n, int torn)
+{
+    f->cut_at = f->ops + n;
+    f->torn = torn;
+}
+
+void hs_test_flash_power_on(hs_test_flash_t *f)
+{
+    f->off = 0;
+    f->cut_at = HS_TEST_FLASH_NEVER;
+}
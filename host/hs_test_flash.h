@@ -0,0 +1,56 @@
+/**
+ * @file hs_test_flash.h
+ * @brief HeySalad T5 Terminal - RAM flash with power cut injection
+ *
+ * NOR semantics: erase sets bytes to 0xFF, writes can only clear bits.
+ * Every write and erase is one op. hs_test_flash_cut() makes op n lose
+ * power, either before it starts or halfway through (torn), after which
+ * every access fails until hs_test_flash_power_on():
+ *
+ *   for (n = 0; n < ops_of_commit; n++) {
+ *       restore image; hs_test_flash_cut(&f, n, torn);
+ *       commit; hs_test_flash_power_on(&f); reinit and check
+ *   }
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#ifndef HS_TEST_FLASH_H
+#define HS_TEST_FLASH_H
+
+#include <stdint.h>
+
+#include "hs_flash.h"
+
+#define HS_TEST_FLASH_MAX_SECTORS   64
+#define HS_TEST_FLASH_NEVER         UINT32_MAX
+
+typedef struct {
+    uint8_t *mem;
+    uint32_t size;
+    uint32_t sector_size;
+    uint32_t ops;           // Writes and erases since power on
+    uint32_t cut_at;        // Op that loses power
+    int torn;               // Cut op is half applied
+    int off;                // Power lost, every access fails
+    uint32_t bad_writes;    // Writes that tried to set a cleared bit
+    uint32_t erases[HS_TEST_FLASH_MAX_SECTORS];
+} hs_test_flash_t;
+
+/**
+ * @brief Erase mem and describe all of it as region
+ */
+void hs_test_flash_init(hs_test_flash_t *f, uint8_t *mem, uint32_t size,
+                        uint32_t sector_size, hs_flash_region_t *region);
+
+/**
+ * @brief Lose power at op n counted from now, half applying it if torn
+ */
+void hs_test_flash_cut(hs_test_flash_t *f, uint32_t n, int torn);
+
+/**
+ * @brief Restore power and clear any pending cut
+ */
+void hs_test_flash_power_on(hs_test_flash_t *f);
+
+#endif // HS_TEST_FLASH_H
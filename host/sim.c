@@ -0,0 +1,310 @@
+/**
+ * @file sim.c
+ * @brief HeySalad T5 Terminal - Host simulator
+ *
+ * Runs the terminal core against the Linux HAL and a stub bridge in the
+ * same process, through one complete payment and one firmware update:
+ *
+ *   boot -> WiFi provisioned over the console
+ *        -> two earlier sales, either side of local midnight
+ *        -> "charge fifty" -> QR created, ledger PENDING
+ *        -> background reconcile -> ledger PAID
+ *        -> "check balance" answered from the ledger, for the local day
+ *        -> payments the bridge never settles expired locally, a batch
+ *           per run, then the radio left alone
+ *        -> telemetry uploaded, terminal asleep, wakes within target
+ *        -> delta served from the bridge, downloaded in the background
+ *        -> reboot: update installed, provisioned SSID used, ledger
+ *           read back from flash
+ *        -> "check balance" before SNTP, answered as an overall total
+ *
+ * Exits non-zero if any step does not behave as on the device.
+ *
+ * Usage: hs_sim [flash.bin] [-v]
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "heysalad_config.h"
+#include "hs_hal_linux.h"
+#include "hs_ledger.h"
+#include "hs_power.h"
+#include "hs_terminal.h"
+#include "hs_test.h"
+#include "hs_test_delta.h"
+
+#define SIM_PAYMENT_ID  "pay_sim_0001"
+#define SIM_PATCH_URL   "https://bridge.test/ota/sim.bin"
+#define SIM_IMG_MAX     (HS_TEST_FULL_SIZE + 1024)
+
+// Stub bridge state
+static const char *g_voice_reply = NULL;
+static const char *g_pay_status = "pending";
+static char g_spoken[256];
+static char g_metrics[METRICS_BATCH_MAX];
+static int g_requests = 0;
+static int g_status_requests = 0;
+static int g_offer_patch = 0;
+
+static int reply(const char *text, uint8_t *resp, size_t resp_max, size_t *resp_len)
+{
+    size_t n = strlen(text);
+
+    if (resp) {
+        memcpy(resp, text, n < resp_max ? n : resp_max);
+    }
+    *resp_len = n;
+    return 0;
+}
+
+static int ends_with(const char *s, const char *suffix)
+{
+    size_t a = strlen(s), b = strlen(suffix);
+    return a >= b && strcmp(s + a - b, suffix) == 0;
+}
+
+/**
+ * @brief Stub bridge, payment service and voice agent
+ */
+static int stub_http(void *arg, const char *url, const char *const *headers,
+                     const uint8_t *body, size_t body_len,
+                     uint8_t *resp, size_t resp_max, size_t *resp_len)
+{
+    char buf[256];
+
+    (void)arg;
+    g_requests++;
+    for (int i = 0; headers && headers[i]; i += 2) {
+        if (strcmp(headers[i], "X-HS-Metrics") == 0) {
+            snprintf(g_metrics, sizeof(g_metrics), "%s", headers[i + 1]);
+        }
+    }
+
+    if (ends_with(url, "/api/ota/check")) {
+        return reply(g_offer_patch ? "{\"patch_url\":\"" SIM_PATCH_URL "\"}" : "{\"up_to_date\":true}",
+                     resp, resp_max, resp_len);
+    }
+    if (ends_with(url, "/api/voice/chat")) {
+        if (!g_voice_reply || body_len == 0) {
+            return -1;
+        }
+        return reply(g_voice_reply, resp, resp_max, resp_len);
+    }
+    if (ends_with(url, "/api/payment/create")) {
+        return reply("{\"qr_url\":\"https://pay.heysalad.app/p/" SIM_PAYMENT_ID "\","
+                     "\"payment_id\":\"" SIM_PAYMENT_ID "\"}", resp, resp_max, resp_len);
+    }
+    if (ends_with(url, "/api/payment/status")) {
+        g_status_requests++;
+        snprintf(buf, sizeof(buf), "{\"payment_id\":\"" SIM_PAYMENT_ID "\",\"status\":\"%s\"}", g_pay_status);
+        return reply(buf, resp, resp_max, resp_len);
+    }
+    if (ends_with(url, "/api/voice/speak")) {
+        // Remember the text, answer with 100 ms of silence
+        snprintf(g_spoken, sizeof(g_spoken), "%.*s", (int)body_len, (const char *)body);
+        *resp_len = resp_max < 3200 ? resp_max : 3200;
+        memset(resp, 0, *resp_len);
+        return 0;
+    }
+    if (ends_with(url, "/api/telemetry")) {
+        return reply("{}", resp, resp_max, resp_len);
+    }
+    return -1;
+}
+
+/**
+ * @brief Hold the button while one second of speech is captured
+ */
+static void speak(const char *voice_reply)
+{
+    static uint8_t pcm[16000 * 2];
+
+    for (size_t i = 0; i < sizeof(pcm); i++) {
+        pcm[i] = (uint8_t)(i * 7);
+    }
+    g_voice_reply = voice_reply;
+
+    hs_terminal_button(1);
+    hs_hal_linux_event();
+    hs_terminal_step();
+
+    hs_hal_linux_audio_feed(pcm, sizeof(pcm));
+    hs_terminal_step();
+
+    hs_terminal_button(0);
+    hs_hal_linux_event();
+    hs_terminal_step();
+}
+
+/**
+ * @brief Let the terminal idle for ms of simulated time
+ */
+static void idle(const hs_hal_t *hal, uint32_t ms)
+{
+    uint32_t end = hal->now_ms() + ms;
+    uint32_t resets = hs_hal_linux_resets();
+
+    // A reset request ends the run, as it would on the device
+    while ((int32_t)(hal->now_ms() - end) < 0 && hs_hal_linux_resets() == resets) {
+        hs_terminal_step();
+    }
+}
+
+/**
+ * @brief Read the first len bytes of the application partition
+ */
+static int read_app(const hs_hal_t *hal, uint8_t *buf, size_t len)
+{
+    uint32_t base = 0, size = 0;
+
+    if (hal->partition(HS_PART_APP, &base, &size) != 0 || size < len) {
+        return -1;
+    }
+    return hal->flash->read(hal->flash_ctx, base, buf, len);
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = "hs_sim_flash.bin";
+    static uint8_t img[SIM_IMG_MAX], installed[SIM_IMG_MAX];
+    static uint8_t patch[HS_TEST_PATCH_MAX];
+    hs_linux_cfg_t cfg = { 0 };
+    hs_ledger_entry_t e;
+    hs_power_stats_t st;
+    char reply_text[256];
+    uint32_t count = 0;
+    int64_t sum = 0;
+    size_t img_len = 0, patch_len = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0) {
+            cfg.verbose = 1;
+        } else {
+            path = argv[i];
+        }
+    }
+    remove(path);
+
+    cfg.flash_path = path;
+    cfg.flash_size = HS_LINUX_FLASH_SIZE;
+    cfg.http = stub_http;
+
+    printf("boot\n");
+    const hs_hal_t *hal = hs_hal_linux_init(&cfg);
+    if (!hal) {
+        return 2;
+    }
+    hs_terminal_init(hal);
+    CHECK(hs_terminal_start() == 0, "WiFi up, main loop entered");
+    CHECK(strcmp(hs_hal_linux_ssid(), WIFI_SSID) == 0, "factory default SSID used");
+    CHECK(hs_ledger_count() == 0, "ledger empty on fresh flash");
+
+    printf("provision\n");
+    hs_terminal_console("cfg set wifi_ssid Sim Stall 1\r\n", reply_text, sizeof(reply_text));
+    hs_terminal_console("cfg set wifi_pass sim-secret", reply_text, sizeof(reply_text));
+    hs_terminal_console("cfg commit", reply_text, sizeof(reply_text));
+    CHECK(strcmp(reply_text, "OK\n") == 0, "settings committed");
+    hs_terminal_console("cfg get wifi_pass", reply_text, sizeof(reply_text));
+    CHECK(strstr(reply_text, "sim-secret") == NULL, "password masked on the console");
+
+    // The clock starts at UTC midnight: 23:00 yesterday and 01:00 today in Lusaka (UTC+2)
+    printf("earlier sales\n");
+    hs_ledger_add(hal->time_s() - 3 * 3600, 700, "ZMW", "pay_sim_0000a", HS_LEDGER_PAID, NULL);
+    hs_ledger_add(hal->time_s() - 3600, 1000, "ZMW", "pay_sim_0000b", HS_LEDGER_PAID, NULL);
+
+    printf("charge fifty\n");
+    speak("{\"action\":\"payment\",\"amount\":50}");
+    CHECK(hs_ledger_count() == 3, "payment recorded in ledger");
+    CHECK(hs_ledger_next_pending(0, &e) == 0 && e.amount == 5000, "ledger entry PENDING, 50.00");
+    CHECK(strstr(g_spoken, "Payment created") != NULL, "confirmation spoken");
+    CHECK(hs_hal_linux_played() > 0, "speech played");
+
+    printf("customer pays\n");
+    g_pay_status = "paid";
+    idle(hal, LEDGER_RECONCILE_INTERVAL_MS + 1000);
+    CHECK(hs_ledger_last(HS_LEDGER_PAID, &e) == 0 && e.amount == 5000 && e.synced,
+          "reconcile marked payment PAID");
+    CHECK(hs_ledger_next_pending(0, &e) != 0, "nothing left pending");
+
+    printf("check balance\n");
+    speak("{\"action\":\"balance\"}");
+    CHECK(strstr(g_spoken, "Today you received 2 payments, total 60.00") != NULL,
+          "balance answered from ledger for the local day");
+
+    printf("payments never settled\n");
+    g_pay_status = "pending";
+    for (int i = 0; i < LEDGER_RECONCILE_BATCH + 1; i++) {
+        char ref[HS_LEDGER_REF_MAX];
+        snprintf(ref, sizeof(ref), "pay_sim_old%d", i);
+        hs_ledger_add(hal->time_s() - 3600, 100, "ZMW", ref, HS_LEDGER_PENDING, NULL);
+    }
+    hs_ledger_add(hal->time_s() - 3600, 100, "ZMW", "", HS_LEDGER_PENDING, NULL);
+    idle(hal, LEDGER_RECONCILE_INTERVAL_MS + 1000);
+    CHECK(g_status_requests == 1 + LEDGER_RECONCILE_BATCH && hs_ledger_next_pending(0, &e) == 0 &&
+          hs_ledger_last(HS_LEDGER_EXPIRED, &e) == 0, "one batch asked about, timed out ones expired");
+    idle(hal, LEDGER_RECONCILE_INTERVAL_MS + 1000);
+    CHECK(hs_ledger_next_pending(0, &e) != 0, "next run took the rest, no id ones too");
+    int status_requests = g_status_requests;
+    idle(hal, 3 * LEDGER_RECONCILE_INTERVAL_MS);
+    CHECK(g_status_requests == status_requests, "bridge no longer asked");
+
+    printf("telemetry\n");
+    idle(hal, METRICS_INTERVAL_MS + METRICS_FLUSH_MS + 1000);
+    CHECK(g_metrics[0] == '1' && strstr(g_metrics, "|h:") != NULL, "metrics batch uploaded");
+    printf("        %s\n", g_metrics);
+
+    printf("power\n");
+    hs_power_get_stats(&st);
+    CHECK(st.state == HS_POWER_SLEEP, "asleep while idle");
+    CHECK(st.time_ms[HS_POWER_SLEEP] > st.time_ms[HS_POWER_ACTIVE], "most time spent asleep");
+    speak("{\"text\":\"Hello\"}");
+    hs_power_get_stats(&st);
+    CHECK(st.wakes[HS_POWER_WAKE_BUTTON] >= 3 && st.slow_wakes == 0 &&
+          st.last_wake_ms < POWER_WAKE_TARGET_MS, "button wakes within target");
+
+    printf("firmware update\n");
+    // Flashed over USB, so no package to patch against: a whole image
+    patch_len = hs_test_delta(NULL, 0, img, &img_len, patch);
+    hs_hal_linux_serve(SIM_PATCH_URL, patch, patch_len);
+    g_offer_patch = 1;
+    idle(hal, OTA_CHECK_INTERVAL_MS + 60000);
+    g_offer_patch = 0;
+    CHECK(hs_hal_linux_served() == patch_len, "patch downloaded once, in the background");
+    CHECK(hs_hal_linux_resets() == 1, "reset into the update");
+
+    printf("reboot\n");
+    hs_hal_linux_close();
+    hal = hs_hal_linux_init(&cfg);
+    if (!hal) {
+        return 2;
+    }
+    CHECK(read_app(hal, installed, img_len) == 0 && memcmp(installed, img, img_len) == 0,
+          "bootloader installed the update");
+    hs_terminal_init(hal);
+    CHECK(hs_terminal_start() == 0, "new image up");
+    CHECK(strcmp(hs_hal_linux_ssid(), "Sim Stall 1") == 0, "provisioned SSID used");
+    hs_ledger_totals(HS_LEDGER_PAID, 0, &count, &sum);
+    CHECK(count == 3 && sum == 6700, "ledger survives reboot");
+    CHECK(hs_hal_linux_resets() == 1, "no unexpected reset");
+    hs_hal_linux_close();
+
+    printf("check balance before SNTP\n");
+    cfg.no_sntp = 1;
+    hal = hs_hal_linux_init(&cfg);
+    if (!hal) {
+        return 2;
+    }
+    hs_terminal_init(hal);
+    CHECK(hs_terminal_start() == 0, "WiFi up without SNTP");
+    speak("{\"action\":\"balance\"}");
+    CHECK(strstr(g_spoken, "Clock not set yet. In total you received 3 payments, total 67.00") != NULL,
+          "balance qualified while the clock is unset");
+    hs_hal_linux_close();
+
+    printf("%d requests\n", g_requests);
+    return TEST_RESULT();
+}
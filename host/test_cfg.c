@@ -0,0 +1,196 @@
+/**
+ * @file test_cfg.c
+ * @brief HeySalad T5 Terminal - Configuration store host test
+ *
+ * Runs hs_cfg on a RAM flash with the device layout (CFG_STORE_SECTORS of
+ * FLASH_SECTOR_SIZE) and cuts power at every write and erase boundary of
+ * a commit, both before the op and halfway through it. After each cut the
+ * store is re-initialised: the old or the new snapshot must load, never a
+ * mix, and the next commit must succeed. Commits cycle the ring several
+ * times, so cuts land on sector rotations too. Finally checks that erases
+ * are spread evenly across the ring.
+ *
+ * Usage: test_cfg
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "heysalad_config.h"
+#include "hs_cfg.h"
+#include "hs_test.h"
+#include "hs_test_flash.h"
+
+#define CFG_SIZE        (CFG_STORE_SECTORS * FLASH_SECTOR_SIZE)
+#define CUT_COMMITS     300
+#define WEAR_COMMITS    2000
+
+static uint8_t g_mem[CFG_SIZE];
+static uint8_t g_image[CFG_SIZE];
+static hs_test_flash_t g_flash;
+static hs_flash_region_t g_region;
+
+/**
+ * @brief Stage snapshot n: the ssid names it, the password length varies
+ *        so records are not all the same size
+ */
+static void stage(int n)
+{
+    char ssid[33], pass[65];
+
+    snprintf(ssid, sizeof(ssid), "ssid-%d", n);
+    memset(pass, 'a' + n % 26, sizeof(pass));
+    pass[8 + n % 56] = '\0';
+    hs_cfg_set("wifi_ssid", ssid);
+    hs_cfg_set("wifi_pass", pass);
+}
+
+/**
+ * @brief Whether the loaded configuration is exactly snapshot n
+ */
+static int is_snapshot(int n)
+{
+    char ssid[33];
+
+    snprintf(ssid, sizeof(ssid), "ssid-%d", n);
+    return strcmp(hs_cfg()->wifi_ssid, ssid) == 0 &&
+           strlen(hs_cfg()->wifi_pass) == (size_t)(8 + n % 56) &&
+           hs_cfg()->wifi_pass[0] == 'a' + n % 26 &&
+           strcmp(hs_cfg()->bridge_url, HEYSALAD_TUYA_BRIDGE) == 0;
+}
+
+/**
+ * @brief Commit snapshot n from the current image, counting flash ops
+ */
+static uint32_t commit_ops(int n)
+{
+    uint32_t ops = g_flash.ops;
+
+    hs_cfg_init(&g_region);
+    stage(n);
+    if (hs_cfg_commit() != 0) {
+        return 0;
+    }
+    return g_flash.ops - ops;
+}
+
+/**
+ * @brief Cut power at op cut of committing snapshot n, then reboot
+ *
+ * @return 0 if the store recovered as required
+ */
+static int cut_commit(int n, uint32_t cut, int torn)
+{
+    int rt = 0;
+
+    memcpy(g_mem, g_image, sizeof(g_mem));
+    hs_cfg_init(&g_region);
+    stage(n);
+    hs_test_flash_cut(&g_flash, cut, torn);
+    rt = hs_cfg_commit();
+    hs_test_flash_power_on(&g_flash);
+
+    // A failed commit leaves the old snapshot live, a cut one may not be lost
+    if ((rt == 0 && !is_snapshot(n)) || (rt != 0 && !is_snapshot(n - 1))) {
+        return -1;
+    }
+
+    hs_cfg_init(&g_region);
+    if (!is_snapshot(n) && !is_snapshot(n - 1)) {
+        printf("        cut %u%s of commit %d loaded \"%s\"\n",
+               (unsigned)cut, torn ? " torn" : "", n, hs_cfg()->wifi_ssid);
+        return -1;
+    }
+
+    // The store carries on after the torn record
+    stage(n + 1);
+    if (hs_cfg_commit() != 0) {
+        return -1;
+    }
+    hs_cfg_init(&g_region);
+    return is_snapshot(n + 1) ? 0 : -1;
+}
+
+int main(void)
+{
+    char out[256];
+    int bad = 0, rotations = 0;
+    uint32_t cuts = 0, min = UINT32_MAX, max = 0;
+
+    hs_test_flash_init(&g_flash, g_mem, sizeof(g_mem), FLASH_SECTOR_SIZE, &g_region);
+
+    printf("defaults\n");
+    CHECK(hs_cfg_init(&g_region) != 0, "blank flash reports no snapshot");
+    CHECK(strcmp(hs_cfg()->wifi_ssid, WIFI_SSID) == 0 &&
+          strcmp(hs_cfg()->device_key, TUYA_DEVICE_KEY) == 0, "factory defaults loaded");
+    hs_cfg_provision_line("cfg get wifi_pass", out, sizeof(out));
+    CHECK(strstr(out, WIFI_PASS) == NULL, "secret masked");
+
+    printf("provision\n");
+    hs_cfg_provision_line("cfg set wifi_ssid Market Stall 4\r\n", out, sizeof(out));
+    hs_cfg_provision_line("cfg set wifi_timeout_ms 15000", out, sizeof(out));
+    hs_cfg_provision_line("cfg commit", out, sizeof(out));
+    CHECK(strcmp(out, "OK\n") == 0, "commit acknowledged");
+    hs_cfg_init(&g_region);
+    CHECK(strcmp(hs_cfg()->wifi_ssid, "Market Stall 4") == 0 &&
+          hs_cfg()->wifi_timeout_ms == 15000, "values survive reboot");
+    CHECK(hs_cfg()->utc_offset_min == LOCAL_UTC_OFFSET_MIN, "key missing from snapshot keeps its default");
+    hs_cfg_provision_line("cfg set utc_offset_min -300", out, sizeof(out));
+    hs_cfg_provision_line("cfg commit", out, sizeof(out));
+    hs_cfg_init(&g_region);
+    hs_cfg_provision_line("cfg get utc_offset_min", out, sizeof(out));
+    CHECK(hs_cfg()->utc_offset_min == -300 && strcmp(out, "utc_offset_min=-300\n") == 0,
+          "signed value survives reboot");
+
+    printf("power cut at every write and erase\n");
+    hs_test_flash_init(&g_flash, g_mem, sizeof(g_mem), FLASH_SECTOR_SIZE, &g_region);
+    hs_cfg_init(&g_region);
+    stage(0);
+    hs_cfg_commit();
+    for (int n = 1; n <= CUT_COMMITS; n++) {
+        uint32_t ops = 0;
+
+        memcpy(g_image, g_mem, sizeof(g_image));
+        ops = commit_ops(n);
+        if (ops == 0) {
+            bad++;
+            break;
+        }
+        rotations += ops > 3;
+
+        for (uint32_t cut = 0; cut < ops; cut++) {
+            for (int torn = 0; torn < 2; torn++) {
+                bad += cut_commit(n, cut, torn) != 0;
+                cuts++;
+            }
+        }
+
+        // Move on from the uncut commit
+        memcpy(g_mem, g_image, sizeof(g_mem));
+        commit_ops(n);
+    }
+    printf("        %u cuts, %d rotations\n", (unsigned)cuts, rotations);
+    CHECK(bad == 0, "old or new snapshot after every cut");
+    CHECK(rotations >= CFG_STORE_SECTORS, "cuts covered sector rotations");
+    CHECK(g_flash.bad_writes == 0, "no write over unerased bytes");
+
+    printf("wear\n");
+    hs_test_flash_init(&g_flash, g_mem, sizeof(g_mem), FLASH_SECTOR_SIZE, &g_region);
+    hs_cfg_init(&g_region);
+    for (int n = 0; n < WEAR_COMMITS; n++) {
+        stage(n);
+        bad += hs_cfg_commit() != 0;
+    }
+    hs_cfg_init(&g_region);
+    CHECK(bad == 0 && is_snapshot(WEAR_COMMITS - 1), "every commit stored");
+    for (int s = 0; s < CFG_STORE_SECTORS; s++) {
+        min = g_flash.erases[s] < min ? g_flash.erases[s] : min;
+        max = g_flash.erases[s] > max ? g_flash.erases[s] : max;
+    }
+    printf("        erases per sector %u..%u\n", (unsigned)min, (unsigned)max);
+    CHECK(min > 0 && max - min <= 1, "erases rotate evenly across the ring");
+
+    return TEST_RESULT();
+}
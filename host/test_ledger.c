@@ -0,0 +1,300 @@
+/**
+ * @file test_ledger.c
+ * @brief HeySalad T5 Terminal - Ledger crash consistency host test
+ *
+ * Runs hs_ledger on a RAM flash with the device layout (LEDGER_SECTORS of
+ * FLASH_SECTOR_SIZE) next to a model of the index. For every add and
+ * update, power is cut at each write and erase it makes, before the op
+ * and halfway through it, so cuts land in write_slot(), in the copies of
+ * compact() and in its erase. After each cut the ledger is re-initialised
+ * and its counts, sums, hs_ledger_last() and pending list must match the
+ * model before or after the operation. Every RECOVERY_STRIDE-th torn write
+ * of a compaction is followed by a second cut at each op of the recovery
+ * it triggers at the next boot.
+ *
+ * The workload cycles the ring several times, then fills a sector with
+ * records that are all still current when it is compacted.
+ *
+ * Usage: test_ledger
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "heysalad_config.h"
+#include "hs_ledger.h"
+#include "hs_test.h"
+#include "hs_test_flash.h"
+
+#define LEDGER_SIZE     (LEDGER_SECTORS * FLASH_SECTOR_SIZE)
+#define SLOTS_PER_SECTOR (FLASH_SECTOR_SIZE / 64)
+#define RANDOM_OPS      600
+#define RECOVERY_STRIDE 4       // Compaction cuts followed by a recovery sweep
+
+typedef struct {
+    uint32_t txn;
+    int32_t amount;
+    uint8_t status;
+} model_txn_t;
+
+// What the index must hold: the newest LEDGER_MAX_TXNS transactions
+typedef struct {
+    model_txn_t t[LEDGER_MAX_TXNS];
+    uint32_t n;
+    uint32_t next_txn;
+} model_t;
+
+typedef struct {
+    int add;                // Otherwise update
+    uint32_t txn;           // Transaction updated
+    int32_t amount;
+    uint8_t status;
+} op_t;
+
+static uint8_t g_mem[LEDGER_SIZE];
+static uint8_t g_image[LEDGER_SIZE];
+static hs_test_flash_t g_flash;
+static hs_flash_region_t g_region;
+static model_t g_model, g_next;
+
+static uint32_t g_seed = 7;
+static uint32_t g_cuts = 0;
+static uint32_t g_recovery_cuts = 0;
+static int g_bad = 0;
+
+static uint32_t rnd(void)
+{
+    g_seed = g_seed * 1103515245 + 12345;
+    return g_seed >> 8;
+}
+
+static void ref_of(uint32_t txn, char *ref, size_t len)
+{
+    snprintf(ref, len, "pay_%08u", (unsigned)txn);
+}
+
+// ============================================
+// Model
+// ============================================
+
+static void model_apply(model_t *m, const op_t *op)
+{
+    if (op->add) {
+        if (m->n == LEDGER_MAX_TXNS) {
+            memmove(&m->t[0], &m->t[1], (m->n - 1) * sizeof(m->t[0]));
+            m->n--;
+        }
+        m->t[m->n].txn = m->next_txn++;
+        m->t[m->n].amount = op->amount;
+        m->t[m->n].status = HS_LEDGER_PENDING;
+        m->n++;
+        return;
+    }
+    for (uint32_t i = 0; i < m->n; i++) {
+        if (m->t[i].txn == op->txn) {
+            m->t[i].status = op->status;
+        }
+    }
+}
+
+/**
+ * @brief Whether the ledger's counts, sums, last entries and pending list
+ *        match the model
+ */
+static int model_matches(const model_t *m)
+{
+    hs_ledger_entry_t e;
+    uint32_t after = 0, i = 0;
+
+    if (hs_ledger_count() != m->n) {
+        return 0;
+    }
+    for (int s = 0; s < HS_LEDGER_STATUS_MAX; s++) {
+        uint32_t count = 0, want_count = 0;
+        int64_t sum = 0, want_sum = 0;
+        const model_txn_t *last = NULL;
+
+        for (i = 0; i < m->n; i++) {
+            if (m->t[i].status == s) {
+                want_count++;
+                want_sum += m->t[i].amount;
+                last = &m->t[i];
+            }
+        }
+        hs_ledger_totals(s, 0, &count, &sum);
+        if (count != want_count || sum != want_sum) {
+            return 0;
+        }
+        if (last ? (hs_ledger_last(s, &e) != 0 || e.txn != last->txn || e.amount != last->amount)
+                 : hs_ledger_last(s, &e) == 0) {
+            return 0;
+        }
+    }
+    for (i = 0; i < m->n; i++) {
+        if (m->t[i].status != HS_LEDGER_PENDING) {
+            continue;
+        }
+        if (hs_ledger_next_pending(after, &e) != 0 || e.txn != m->t[i].txn) {
+            return 0;
+        }
+        after = e.txn;
+    }
+    return hs_ledger_next_pending(after, &e) != 0;
+}
+
+// ============================================
+// Power cuts
+// ============================================
+
+static int run_op(const op_t *op)
+{
+    char ref[HS_LEDGER_REF_MAX];
+
+    if (op->add) {
+        ref_of(g_model.next_txn, ref, sizeof(ref));
+        return hs_ledger_add(1700000000 + g_model.next_txn, op->amount, "ZMW", ref,
+                             HS_LEDGER_PENDING, NULL);
+    }
+    ref_of(op->txn, ref, sizeof(ref));
+    return hs_ledger_update(ref, op->status, 1);
+}
+
+/**
+ * @brief Reboot and check the ledger holds the old or the new state
+ */
+static int reboot_matches(void)
+{
+    hs_test_flash_power_on(&g_flash);
+    hs_ledger_init(&g_region);
+    return model_matches(&g_model) || model_matches(&g_next);
+}
+
+/**
+ * @brief Cut power at every op of op, and of the recovery after a cut
+ *        in a compaction
+ */
+static void cut_sweep(const op_t *op)
+{
+    uint32_t ops = 0;
+
+    // Count the ops on an uncut run
+    memcpy(g_mem, g_image, sizeof(g_mem));
+    hs_ledger_init(&g_region);
+    ops = g_flash.ops;
+    run_op(op);
+    ops = g_flash.ops - ops;
+
+    for (uint32_t cut = 0; cut < ops; cut++) {
+        for (int torn = 0; torn < 2; torn++) {
+            uint32_t recovery = 0;
+
+            memcpy(g_mem, g_image, sizeof(g_mem));
+            hs_ledger_init(&g_region);
+            hs_test_flash_cut(&g_flash, cut, torn);
+            run_op(op);
+            g_cuts++;
+
+            hs_test_flash_power_on(&g_flash);
+            recovery = g_flash.ops;
+            if (!reboot_matches()) {
+                printf("        cut %u%s of %u: state lost\n", (unsigned)cut, torn ? " torn" : "", (unsigned)ops);
+                g_bad++;
+                continue;
+            }
+            recovery = g_flash.ops - recovery;
+            if (ops <= 2 || !torn || cut % RECOVERY_STRIDE != 0 || recovery == 0) {
+                continue;
+            }
+
+            // Cut again inside the recovery of an interrupted compaction
+            for (uint32_t again = 0; again < recovery; again++) {
+                memcpy(g_mem, g_image, sizeof(g_mem));
+                hs_ledger_init(&g_region);
+                hs_test_flash_cut(&g_flash, cut, torn);
+                run_op(op);
+                hs_test_flash_power_on(&g_flash);
+                hs_test_flash_cut(&g_flash, again, 1);
+                hs_ledger_init(&g_region);
+                g_recovery_cuts++;
+                if (!reboot_matches()) {
+                    printf("        cut %u%s of %u, then %u of recovery: state lost\n",
+                           (unsigned)cut, torn ? " torn" : "", (unsigned)ops, (unsigned)again);
+                    g_bad++;
+                }
+            }
+        }
+    }
+
+    // Move on from the uncut run
+    memcpy(g_mem, g_image, sizeof(g_mem));
+    hs_ledger_init(&g_region);
+    if (run_op(op) != 0) {
+        g_bad++;
+    }
+    hs_ledger_init(&g_region);
+    memcpy(g_image, g_mem, sizeof(g_image));
+    g_model = g_next;
+}
+
+static void step(const op_t *op)
+{
+    g_next = g_model;
+    model_apply(&g_next, op);
+    cut_sweep(op);
+}
+
+static void add(int32_t amount)
+{
+    op_t op = { 1, 0, amount, HS_LEDGER_PENDING };
+    step(&op);
+}
+
+static void update(uint32_t txn, uint8_t status)
+{
+    op_t op = { 0, txn, 0, status };
+    step(&op);
+}
+
+int main(void)
+{
+    uint32_t first = 0;
+
+    hs_test_flash_init(&g_flash, g_mem, sizeof(g_mem), FLASH_SECTOR_SIZE, &g_region);
+    memcpy(g_image, g_mem, sizeof(g_image));
+    g_model.next_txn = 1;
+    CHECK(hs_ledger_init(&g_region) == 0 && model_matches(&g_model), "blank flash, empty ledger");
+
+    printf("random adds and updates\n");
+    for (int i = 0; i < RANDOM_OPS; i++) {
+        if (g_model.n == 0 || rnd() % 5 < 3) {
+            add((int32_t)(rnd() % 100000));
+        } else {
+            const model_txn_t *t = &g_model.t[g_model.n - 1 - rnd() % (g_model.n < 40 ? g_model.n : 40)];
+            update(t->txn, (uint8_t)(1 + rnd() % (HS_LEDGER_STATUS_MAX - 1)));
+        }
+    }
+    printf("        %u cuts, %u in recovery\n", (unsigned)g_cuts, (unsigned)g_recovery_cuts);
+    CHECK(g_bad == 0, "old or new state after every cut");
+    CHECK(g_model.next_txn > LEDGER_MAX_TXNS && g_model.n == LEDGER_MAX_TXNS, "index wrapped");
+
+    printf("compacting a sector of current records\n");
+    g_cuts = g_recovery_cuts = 0;
+    first = g_model.next_txn;
+    // Two sectors of adds, so at least one holds nothing else
+    for (int i = 0; i < 2 * SLOTS_PER_SECTOR; i++) {
+        add(100 + i);
+    }
+    // Keep rewriting older ones until the ring comes back round
+    for (int i = 0; i < LEDGER_SECTORS * SLOTS_PER_SECTOR; i++) {
+        update(first - 1 - i % 32, (i / 32) % 2 ? HS_LEDGER_PAID : HS_LEDGER_FAILED);
+    }
+    printf("        %u cuts, %u in recovery\n", (unsigned)g_cuts, (unsigned)g_recovery_cuts);
+    CHECK(g_bad == 0, "old or new state after every cut");
+    CHECK(g_model.t[g_model.n - 1].txn == first + 2 * SLOTS_PER_SECTOR - 1 &&
+          model_matches(&g_model), "sector of current records carried over");
+    CHECK(g_flash.bad_writes == 0, "no write over unerased bytes");
+
+    return TEST_RESULT();
+}
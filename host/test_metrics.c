@@ -0,0 +1,254 @@
+/**
+ * @file test_metrics.c
+ * @brief HeySalad T5 Terminal - Telemetry host test
+ *
+ * Records into hs_metrics and delivers each batch to a stub collector that
+ * parses the line and keeps the newest batch per sequence number, as the
+ * bridge does. Uploads fail, succeed, or reach the collector with the
+ * reply lost; after every round the collector's totals must equal what
+ * was recorded, so nothing is lost or counted twice.
+ *
+ * Usage: test_metrics
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "heysalad_config.h"
+#include "hs_metrics.h"
+#include "hs_test.h"
+
+#define SEQ_MAX         64
+#define ROUNDS          40
+
+typedef struct {
+    uint32_t counter[HS_METRIC_COUNTER_MAX];
+    int32_t  gauge[HS_METRIC_GAUGE_MAX];
+    uint32_t count[HS_METRIC_HIST_MAX];
+    uint32_t sum[HS_METRIC_HIST_MAX];
+    uint32_t bucket[HS_METRIC_HIST_MAX][HS_METRICS_BUCKETS];
+} totals_t;
+
+// Stub collector: the newest batch received for each sequence number
+static totals_t g_batches[SEQ_MAX];
+static int g_have[SEQ_MAX];
+static uint32_t g_received = 0;
+
+// What the terminal recorded
+static totals_t g_recorded;
+
+static uint32_t g_seed = 3;
+
+static uint32_t rnd(void)
+{
+    g_seed = g_seed * 1103515245 + 12345;
+    return g_seed >> 8;
+}
+
+/**
+ * @brief Parse one batch line into t
+ *
+ * @return Sequence number, -1 if the line is malformed
+ */
+static int parse(const char *line, totals_t *t)
+{
+    char buf[METRICS_BATCH_MAX];
+    char *sec = NULL, *save = NULL;
+    int seq = -1;
+    unsigned period = 0;
+
+    memset(t, 0, sizeof(*t));
+    snprintf(buf, sizeof(buf), "%s", line);
+    if (sscanf(buf, "1|%d|%u", &seq, &period) != 2) {
+        return -1;
+    }
+    // Skip version, seq and period
+    strtok_r(buf, "|", &save);
+    strtok_r(NULL, "|", &save);
+    strtok_r(NULL, "|", &save);
+    for (sec = strtok_r(NULL, "|", &save); sec; sec = strtok_r(NULL, "|", &save)) {
+        char *item = NULL, *isave = NULL;
+        char kind = sec[0];
+
+        for (item = strtok_r(sec + 2, ",", &isave); item; item = strtok_r(NULL, ",", &isave)) {
+            int id = atoi(item);
+            char *v = strchr(item, '=') + 1;
+
+            if (kind == 'c') {
+                t->counter[id] = (uint32_t)strtoul(v, NULL, 10);
+            } else if (kind == 'g') {
+                t->gauge[id] = (int32_t)strtol(v, NULL, 10);
+            } else {
+                char *p = v;
+                t->count[id] = (uint32_t)strtoul(p, &p, 10);
+                t->sum[id] = (uint32_t)strtoul(p + 1, &p, 10);
+                for (int b = 0; *p && b < HS_METRICS_BUCKETS; b++) {
+                    t->bucket[id][b] = (uint32_t)strtoul(p + 1, &p, 10);
+                }
+            }
+        }
+    }
+    return seq >= 0 && seq < SEQ_MAX ? seq : -1;
+}
+
+static int collect(const char *line)
+{
+    totals_t t;
+    int seq = parse(line, &t);
+
+    if (seq < 0) {
+        return -1;
+    }
+    g_batches[seq] = t;
+    g_have[seq] = 1;
+    g_received++;
+    return 0;
+}
+
+/**
+ * @brief Collector totals match what was recorded
+ */
+static int collector_matches(void)
+{
+    totals_t sum;
+    int newest = -1;
+
+    memset(&sum, 0, sizeof(sum));
+    for (int s = 0; s < SEQ_MAX; s++) {
+        if (!g_have[s]) {
+            continue;
+        }
+        for (int i = 0; i < HS_METRIC_COUNTER_MAX; i++) {
+            sum.counter[i] += g_batches[s].counter[i];
+        }
+        for (int i = 0; i < HS_METRIC_HIST_MAX; i++) {
+            sum.count[i] += g_batches[s].count[i];
+            sum.sum[i] += g_batches[s].sum[i];
+            for (int b = 0; b < HS_METRICS_BUCKETS; b++) {
+                sum.bucket[i][b] += g_batches[s].bucket[i][b];
+            }
+        }
+        newest = s;
+    }
+    if (newest >= 0) {
+        memcpy(sum.gauge, g_batches[newest].gauge, sizeof(sum.gauge));
+    }
+    return memcmp(&sum, &g_recorded, sizeof(sum)) == 0;
+}
+
+static void observe(hs_metric_hist_t id, uint32_t ms)
+{
+    static const uint32_t bounds[HS_METRICS_BUCKETS - 1] = { 50, 100, 250, 500, 1000, 2500, 5000 };
+    int b = 0;
+
+    while (b < HS_METRICS_BUCKETS - 1 && ms > bounds[b]) {
+        b++;
+    }
+    hs_metrics_observe(id, ms);
+    g_recorded.count[id]++;
+    g_recorded.sum[id] += ms;
+    g_recorded.bucket[id][b]++;
+}
+
+/**
+ * @brief Record a random period of activity
+ */
+static void record(void)
+{
+    for (uint32_t n = rnd() % 6; n > 0; n--) {
+        hs_metric_counter_t id = (hs_metric_counter_t)(rnd() % HS_METRIC_COUNTER_MAX);
+        hs_metrics_inc(id);
+        g_recorded.counter[id]++;
+    }
+    for (uint32_t n = rnd() % 8; n > 0; n--) {
+        observe((hs_metric_hist_t)(rnd() % HS_METRIC_HIST_MAX), rnd() % 7000);
+    }
+    if (rnd() % 2) {
+        int32_t v = (int32_t)(rnd() % 100000);
+        hs_metrics_set(HS_METRIC_HEAP_FREE, v);
+        g_recorded.gauge[HS_METRIC_HEAP_FREE] = v;
+    }
+}
+
+int main(void)
+{
+    char line[METRICS_BATCH_MAX];
+    uint32_t now = 0;
+    int n = 0, bad = 0;
+    uint32_t failed = 0, lost_replies = 0;
+    totals_t t;
+
+    hs_metrics_init(now);
+
+    printf("deltas\n");
+    CHECK(hs_metrics_batch(now, line, sizeof(line)) == 0, "nothing to report on a quiet start");
+    hs_metrics_inc(HS_METRIC_HTTP_ERRORS);
+    hs_metrics_add(HS_METRIC_WIFI_RECONNECTS, 2);
+    hs_metrics_observe(HS_METRIC_VOICE_MS, 120);
+    hs_metrics_observe(HS_METRIC_VOICE_MS, 40);
+    now += METRICS_INTERVAL_MS;
+    n = hs_metrics_batch(now, line, sizeof(line));
+    printf("        %s\n", line);
+    CHECK(n > 0 && strcmp(line, "1|0|300|c:0=1,3=2|g:0=0,1=0|h:1=2/160/1.0.1") == 0,
+          "changed counters, gauges, trimmed buckets");
+    hs_metrics_ack();
+    now += METRICS_INTERVAL_MS;
+    CHECK(hs_metrics_batch(now, line, sizeof(line)) == 0, "acked deltas not sent again");
+    hs_metrics_inc(HS_METRIC_HTTP_ERRORS);
+    n = hs_metrics_batch(now, line, sizeof(line));
+    CHECK(n > 0 && strcmp(line, "1|1|300|c:0=1|g:0=0,1=0") == 0, "next batch only holds the new delta");
+
+    printf("failed upload folds into the next batch\n");
+    hs_metrics_observe(HS_METRIC_HTTP_POST_MS, 700);
+    now += METRICS_INTERVAL_MS;
+    n = hs_metrics_batch(now, line, sizeof(line));
+    CHECK(n > 0 && strcmp(line, "1|1|600|c:0=1|g:0=0,1=0|h:0=1/700/0.0.0.0.1") == 0,
+          "same seq, period and deltas grow");
+    hs_metrics_ack();
+
+    printf("collector\n");
+    hs_metrics_init(now);
+    memset(&g_recorded, 0, sizeof(g_recorded));
+    for (int round = 0; round < ROUNDS; round++) {
+        uint32_t r = rnd() % 4;
+
+        record();
+        now += METRICS_INTERVAL_MS;
+        n = hs_metrics_batch(now, line, sizeof(line));
+        if (n < 0) {
+            bad++;
+            continue;
+        }
+        if (n == 0) {
+            continue;
+        }
+        if (r == 0) {
+            // Request failed, nothing reached the collector
+            failed++;
+        } else if (r == 1) {
+            // Delivered, but the reply was lost: not acked, resent with the same seq
+            bad += collect(line) != 0;
+            lost_replies++;
+        } else {
+            bad += collect(line) != 0;
+            hs_metrics_ack();
+        }
+    }
+    // Final flush that succeeds
+    now += METRICS_INTERVAL_MS;
+    n = hs_metrics_batch(now, line, sizeof(line));
+    if (n > 0) {
+        bad += collect(line) != 0;
+        hs_metrics_ack();
+    }
+    printf("        %u batches received, %u failed, %u replies lost\n",
+           (unsigned)g_received, (unsigned)failed, (unsigned)lost_replies);
+    CHECK(bad == 0, "every batch fits METRICS_BATCH_MAX and parses");
+    CHECK(failed > 0 && lost_replies > 0, "failures and lost replies exercised");
+    CHECK(collector_matches(), "collector totals equal what was recorded");
+    CHECK(parse("2|0|0", &t) < 0, "unknown version rejected");
+
+    return TEST_RESULT();
+}
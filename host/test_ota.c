@@ -0,0 +1,220 @@
+/**
+ * @file test_ota.c
+ * @brief HeySalad T5 Terminal - OTA host test
+ *
+ * Builds real HSD1 deltas (bsdiff ops, heatshrink compressed) between
+ * generated images and applies them through hs_ota with the Linux HAL:
+ * file-backed flash, GETs served from memory, the bootloader emulated at
+ * each re-init. Covers the whole image a USB flashed unit starts from,
+ * resume after a body that ends early (the link dropping under HTTP/1.0),
+ * after a reboot and after a link gone silent, a patch replaced under the
+ * same url, a base CRC mismatch, and rollback to the previous package
+ * after OTA_MAX_BOOT_ATTEMPTS unconfirmed boots, which the first update
+ * has none of.
+ *
+ * Usage: test_ota [flash.bin]
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "heysalad_config.h"
+#include "hs_flash.h"
+#include "hs_hal_linux.h"
+#include "hs_ota.h"
+#include "hs_test.h"
+#include "hs_test_delta.h"
+
+#define IMG_MAX         (256 * 1024)
+#define PATCH_URL       "https://bridge.test/ota/patch.bin"
+
+static hs_linux_cfg_t g_cfg;
+static const hs_hal_t *g_hal = NULL;
+static hs_flash_region_t g_app, g_pkgs, g_meta;
+
+// ============================================
+// Device
+// ============================================
+
+static void region(hs_flash_region_t *r, hs_part_t part)
+{
+    g_hal->partition(part, &r->base, &r->size);
+    r->ops = g_hal->flash;
+    r->ctx = g_hal->flash_ctx;
+    r->sector_size = FLASH_SECTOR_SIZE;
+}
+
+/**
+ * @brief Power up: bootloader, then hs_ota_init() as hs_terminal_init() does
+ */
+static int boot(void)
+{
+    hs_hal_linux_close();
+    g_hal = hs_hal_linux_init(&g_cfg);
+    if (!g_hal) {
+        exit(2);
+    }
+    hs_hal_set(g_hal);
+    region(&g_app, HS_PART_APP);
+    region(&g_pkgs, HS_PART_OTA);
+    region(&g_meta, HS_PART_DATA);
+    g_meta.size = HS_OTA_META_SECTORS * FLASH_SECTOR_SIZE;
+    return hs_ota_init(&g_app, &g_pkgs, &g_meta);
+}
+
+static uint32_t region_crc(const hs_flash_region_t *r, size_t len)
+{
+    uint32_t crc = 0;
+    hs_flash_crc32(r, 0, len, &crc);
+    return crc;
+}
+
+static int running(const uint8_t *img, size_t len)
+{
+    return region_crc(&g_app, len) == hs_crc32(0, img, len);
+}
+
+/**
+ * @brief Whether either package slot holds img
+ */
+static int staged(const uint8_t *img, size_t len)
+{
+    hs_flash_region_t slot = g_pkgs;
+
+    slot.size = g_pkgs.size / 2;
+    if (region_crc(&slot, len) == hs_crc32(0, img, len)) {
+        return 1;
+    }
+    slot.base += slot.size;
+    return region_crc(&slot, len) == hs_crc32(0, img, len);
+}
+
+/**
+ * @brief Poll until the download settles, sleeping out retry backoffs
+ */
+static int run(void)
+{
+    int rt = HS_OTA_BUSY;
+
+    while ((rt = hs_ota_poll()) == HS_OTA_BUSY) {
+        if (hs_ota_wait_ms() > 0) {
+            g_hal->sleep_ms(hs_ota_wait_ms());
+        }
+    }
+    return rt;
+}
+
+/**
+ * @brief Poll until at least bytes of the patch have been served
+ */
+static void run_until(size_t bytes)
+{
+    size_t start = hs_hal_linux_served();
+
+    while (hs_hal_linux_served() - start < bytes && hs_ota_poll() == HS_OTA_BUSY) {
+        if (hs_ota_wait_ms() > 0) {
+            g_hal->sleep_ms(hs_ota_wait_ms());
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    static uint8_t img[4][IMG_MAX];
+    static uint8_t patch[HS_TEST_PATCH_MAX], patch_b[HS_TEST_PATCH_MAX];
+    size_t img_len[4], patch_len, patch_b_len, served;
+
+    g_cfg.flash_path = argc > 1 ? argv[1] : "test_ota_flash.bin";
+    g_cfg.flash_size = HS_LINUX_FLASH_SIZE;
+    remove(g_cfg.flash_path);
+
+    // Flashed over USB: an image in the application partition, no package
+    img_len[0] = 100000;
+    for (size_t i = 0; i < img_len[0]; i++) {
+        img[0][i] = (uint8_t)(hs_test_rand() % 16);
+    }
+    boot();
+    hs_flash_erase(&g_app, 0, g_app.size);
+    hs_flash_write(&g_app, 0, img[0], img_len[0]);
+
+    printf("body ends early\n");
+    patch_len = hs_test_delta(img[0], img_len[0], img[1], &img_len[1], patch);
+    hs_hal_linux_serve(PATCH_URL, patch, patch_len);
+    CHECK(hs_ota_start(PATCH_URL) == 0 && run() == HS_OTA_FAILED, "no delta against a USB flashed image");
+    patch_len = hs_test_delta(NULL, 0, img[1], &img_len[1], patch);
+    hs_hal_linux_serve(PATCH_URL, patch, patch_len);
+    served = hs_hal_linux_served();
+    CHECK(hs_ota_start(PATCH_URL) == 0, "download started");
+    hs_hal_linux_net_drop(patch_len / 3);
+    run_until(patch_len / 2);
+    hs_hal_linux_net_drop(1000);
+    CHECK(run() == HS_OTA_STAGED, "image staged after two early ends");
+    CHECK(hs_hal_linux_served() - served == patch_len, "every patch byte fetched exactly once");
+    CHECK(staged(img[1], img_len[1]), "staged image matches");
+
+    printf("install, nothing to roll back to\n");
+    uint32_t resets = hs_hal_linux_resets();
+    CHECK(boot() == 0 && running(img[1], img_len[1]), "bootloader installed the new image");
+    CHECK(hs_ota_start(PATCH_URL) != 0, "no new download before the image is confirmed");
+    for (int i = 0; i < OTA_MAX_BOOT_ATTEMPTS; i++) {
+        boot();
+    }
+    CHECK(boot() == 0 && hs_hal_linux_resets() == resets && running(img[1], img_len[1]),
+          "unconfirmed image kept, no previous package");
+
+    printf("body ends early, then a reboot and a silent link\n");
+    patch_len = hs_test_delta(img[1], img_len[1], img[2], &img_len[2], patch);
+    hs_hal_linux_serve(PATCH_URL, patch, patch_len);
+    served = hs_hal_linux_served();
+    CHECK(hs_ota_start(PATCH_URL) == 0, "download started");
+    hs_hal_linux_net_drop(patch_len * 2 / 3);
+    run_until(patch_len * 2 / 3);
+    CHECK(hs_ota_busy() && hs_hal_linux_served() - served == patch_len * 2 / 3,
+          "early end retried, not taken for a corrupt patch");
+    boot();
+    served = hs_hal_linux_served();
+    uint32_t t0 = g_hal->now_ms();
+    hs_hal_linux_net_stall(patch_len / 8);
+    CHECK(hs_ota_start(PATCH_URL) == 0 && run() == HS_OTA_STAGED, "image staged after reboot");
+    CHECK(hs_hal_linux_served() - served < patch_len / 2, "download resumed from the checkpoint");
+    CHECK(g_hal->now_ms() - t0 >= 10000, "silent link waited out, then reconnected");
+    CHECK(boot() == 0 && running(img[2], img_len[2]), "resumed image installed");
+    hs_ota_mark_boot_ok();
+
+    printf("patch replaced under the same url\n");
+    patch_len = hs_test_delta(img[2], img_len[2], img[3], &img_len[3], patch);
+    hs_hal_linux_serve(PATCH_URL, patch, patch_len);
+    hs_ota_start(PATCH_URL);
+    run_until(patch_len * 2 / 3);
+    boot();
+    patch_b_len = hs_test_delta(img[2], img_len[2], img[3], &img_len[3], patch_b);
+    hs_hal_linux_serve(PATCH_URL, patch_b, patch_b_len);
+    served = hs_hal_linux_served();
+    CHECK(hs_ota_start(PATCH_URL) == 0 && run() == HS_OTA_STAGED, "new patch staged");
+    CHECK(hs_hal_linux_served() - served == patch_b_len, "checkpoint of the old patch discarded");
+    CHECK(boot() == 0 && running(img[3], img_len[3]), "new patch installed");
+    hs_ota_mark_boot_ok();
+
+    printf("base mismatch\n");
+    patch_len = hs_test_delta(img[0], img_len[0], img[1], &img_len[1], patch);
+    hs_hal_linux_serve(PATCH_URL, patch, patch_len);
+    CHECK(hs_ota_start(PATCH_URL) == 0 && run() == HS_OTA_FAILED, "delta for another image refused");
+    CHECK(boot() == 0 && running(img[3], img_len[3]), "running image untouched");
+
+    printf("rollback\n");
+    patch_len = hs_test_delta(img[3], img_len[3], img[1], &img_len[1], patch);
+    hs_hal_linux_serve(PATCH_URL, patch, patch_len);
+    CHECK(hs_ota_start(PATCH_URL) == 0 && run() == HS_OTA_STAGED, "image staged");
+    resets = hs_hal_linux_resets();
+    for (int i = 0; i < OTA_MAX_BOOT_ATTEMPTS; i++) {
+        CHECK(boot() == 0 && running(img[1], img_len[1]), "unconfirmed image boots");
+    }
+    CHECK(boot() != 0 && hs_hal_linux_resets() == resets + 1, "rollback reset after the last attempt");
+    CHECK(boot() == 0 && running(img[3], img_len[3]), "previous image restored from its package");
+    CHECK(hs_ota_start(PATCH_URL) == 0, "updates allowed again");
+
+    hs_hal_linux_close();
+    return TEST_RESULT();
+}
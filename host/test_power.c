@@ -0,0 +1,190 @@
+/**
+ * @file test_power.c
+ * @brief HeySalad T5 Terminal - Power manager host test
+ *
+ * Drives hs_power on a hand-stepped clock through the ACTIVE -> IDLE ->
+ * SLEEP timeouts, button and network wakes, nested holds and a wake
+ * raised while the main task holds the wake slot. Then runs the terminal
+ * main loop on the Linux HAL into SLEEP and checks that a button press or
+ * link event is serviced within POWER_WAKE_TARGET_MS instead of waiting
+ * out the POWER_POLL_SLEEP_MS tick.
+ *
+ * Usage: test_power [flash.bin]
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#include <stdio.h>
+
+#include "heysalad_config.h"
+#include "hs_hal_linux.h"
+#include "hs_power.h"
+#include "hs_terminal.h"
+#include "hs_test.h"
+
+static uint32_t g_now = 0;
+static hs_power_state_t g_entered = HS_POWER_STATE_MAX;
+static int g_enters = 0;
+
+// Wake raised from the clock read inside hs_power_wake(), as an interrupt would
+static int g_irq_in_wake = 0;
+
+static uint32_t clock_now_ms(void)
+{
+    if (g_irq_in_wake) {
+        g_irq_in_wake = 0;
+        hs_power_wake(HS_POWER_WAKE_BUTTON);
+    }
+    return g_now;
+}
+
+static void clock_enter(hs_power_state_t state)
+{
+    g_entered = state;
+    g_enters++;
+}
+
+static const hs_power_ops_t g_ops = {
+    .now_ms = clock_now_ms,
+    .enter = clock_enter,
+};
+
+/**
+ * @brief Advance the clock to t, polling at the current state's tick
+ */
+static hs_power_state_t run_to(uint32_t t)
+{
+    while ((int32_t)(t - g_now) > 0) {
+        uint32_t step = hs_power_wait_ms();
+        g_now += (int32_t)(t - g_now) < (int32_t)step ? t - g_now : step;
+        hs_power_poll();
+    }
+    return hs_power_poll();
+}
+
+static hs_power_state_t power_state(void)
+{
+    hs_power_stats_t st;
+    hs_power_get_stats(&st);
+    return st.state;
+}
+
+/**
+ * @brief Step the terminal until it reaches SLEEP or ms pass
+ */
+static int terminal_sleep(const hs_hal_t *hal, uint32_t ms)
+{
+    uint32_t end = hal->now_ms() + ms;
+
+    while (power_state() != HS_POWER_SLEEP && (int32_t)(hal->now_ms() - end) < 0) {
+        hs_terminal_step();
+    }
+    return power_state() == HS_POWER_SLEEP;
+}
+
+int main(int argc, char **argv)
+{
+    hs_linux_cfg_t cfg = { 0 };
+    hs_power_stats_t st;
+    const hs_hal_t *hal = NULL;
+    uint32_t t0 = 0;
+
+    printf("timeouts\n");
+    hs_power_init(&g_ops);
+    CHECK(g_entered == HS_POWER_ACTIVE && hs_power_wait_ms() == POWER_POLL_ACTIVE_MS, "starts ACTIVE");
+    CHECK(run_to(POWER_IDLE_TIMEOUT_MS - 1) == HS_POWER_ACTIVE, "ACTIVE until the idle timeout");
+    CHECK(run_to(POWER_IDLE_TIMEOUT_MS) == HS_POWER_IDLE && g_entered == HS_POWER_IDLE, "IDLE at the idle timeout");
+    CHECK(hs_power_wait_ms() == POWER_POLL_IDLE_MS, "IDLE tick");
+    CHECK(run_to(POWER_SLEEP_TIMEOUT_MS - 1) == HS_POWER_IDLE, "IDLE until the sleep timeout");
+    CHECK(run_to(POWER_SLEEP_TIMEOUT_MS + POWER_POLL_IDLE_MS) == HS_POWER_SLEEP &&
+          g_entered == HS_POWER_SLEEP, "SLEEP after the sleep timeout");
+    CHECK(hs_power_wait_ms() == POWER_POLL_SLEEP_MS, "SLEEP tick");
+    g_enters = 0;
+    run_to(g_now + 10 * POWER_SLEEP_TIMEOUT_MS);
+    CHECK(g_enters == 0, "SLEEP entered once");
+
+    printf("wake on button\n");
+    hs_power_wake(HS_POWER_WAKE_BUTTON);
+    g_now += 5;
+    CHECK(hs_power_poll() == HS_POWER_ACTIVE && g_entered == HS_POWER_ACTIVE, "button wakes to ACTIVE");
+    hs_power_get_stats(&st);
+    CHECK(st.wakes[HS_POWER_WAKE_BUTTON] == 1 && st.last_wake_ms == 5, "wake counted, latency from the event");
+    t0 = g_now;
+    CHECK(run_to(t0 + POWER_IDLE_TIMEOUT_MS) == HS_POWER_IDLE, "timeouts restart from the wake");
+
+    printf("wake on net\n");
+    run_to(g_now + POWER_SLEEP_TIMEOUT_MS);
+    hs_power_wake(HS_POWER_WAKE_NET);
+    hs_power_wake(HS_POWER_WAKE_BUTTON);
+    g_now += POWER_WAKE_TARGET_MS + 1;
+    CHECK(hs_power_poll() == HS_POWER_ACTIVE, "network event wakes to ACTIVE");
+    hs_power_get_stats(&st);
+    CHECK(st.wakes[HS_POWER_WAKE_NET] == 1 && st.wakes[HS_POWER_WAKE_BUTTON] == 1,
+          "second wake merged into the first");
+    CHECK(st.slow_wakes == 1 && st.max_wake_ms == POWER_WAKE_TARGET_MS + 1, "slow wake recorded");
+
+    printf("hold\n");
+    run_to(g_now + POWER_SLEEP_TIMEOUT_MS);
+    hs_power_hold(1);
+    CHECK(g_entered == HS_POWER_ACTIVE, "hold switches to ACTIVE without a poll");
+    hs_power_hold(1);
+    hs_power_hold(0);
+    CHECK(run_to(g_now + 2 * POWER_SLEEP_TIMEOUT_MS) == HS_POWER_ACTIVE, "nested hold keeps ACTIVE");
+    hs_power_hold(0);
+    t0 = g_now;
+    CHECK(run_to(t0 + POWER_IDLE_TIMEOUT_MS - 1) == HS_POWER_ACTIVE &&
+          run_to(t0 + POWER_IDLE_TIMEOUT_MS) == HS_POWER_IDLE, "timeouts restart from the release");
+    hs_power_hold(0);
+    hs_power_hold(1);
+    hs_power_hold(0);
+    CHECK(run_to(g_now + POWER_IDLE_TIMEOUT_MS) == HS_POWER_IDLE, "unbalanced release ignored");
+
+    printf("wake from interrupt during hold\n");
+    hs_power_init(&g_ops);
+    run_to(g_now + POWER_SLEEP_TIMEOUT_MS);
+    g_irq_in_wake = 1;
+    hs_power_hold(1);
+    hs_power_hold(0);
+    hs_power_get_stats(&st);
+    CHECK(st.wakes[HS_POWER_WAKE_APP] == 1 && st.wakes[HS_POWER_WAKE_BUTTON] == 0,
+          "interrupt wake merged into the claimed one");
+    hs_power_wake(HS_POWER_WAKE_BUTTON);
+    hs_power_poll();
+    hs_power_get_stats(&st);
+    CHECK(st.wakes[HS_POWER_WAKE_BUTTON] == 1, "slot free again after the poll");
+
+    printf("terminal wake latency\n");
+    cfg.flash_path = argc > 1 ? argv[1] : "test_power_flash.bin";
+    cfg.flash_size = HS_LINUX_FLASH_SIZE;
+    remove(cfg.flash_path);
+    hal = hs_hal_linux_init(&cfg);
+    if (!hal) {
+        return 2;
+    }
+    hs_terminal_init(hal);
+    hs_terminal_start();
+    CHECK(terminal_sleep(hal, 2 * POWER_SLEEP_TIMEOUT_MS), "main loop reaches SLEEP");
+
+    hs_terminal_step();
+    hs_terminal_button(1);
+    hs_hal_linux_event();
+    hs_terminal_step();
+    hs_power_get_stats(&st);
+    CHECK(st.state == HS_POWER_ACTIVE && hs_hal_linux_led() == HS_LED_LISTENING, "press starts listening");
+    CHECK(st.last_wake_ms < POWER_WAKE_TARGET_MS, "button wake within target");
+    hs_terminal_button(0);
+    hs_hal_linux_event();
+    hs_terminal_step();
+
+    CHECK(terminal_sleep(hal, 2 * POWER_SLEEP_TIMEOUT_MS), "back to SLEEP");
+    hs_terminal_step();
+    hs_terminal_link(1);
+    hs_hal_linux_event();
+    hs_terminal_step();
+    hs_power_get_stats(&st);
+    CHECK(st.state == HS_POWER_ACTIVE && st.last_wake_ms < POWER_WAKE_TARGET_MS, "link wake within target");
+    CHECK(st.slow_wakes == 0, "no slow wakes");
+    hs_hal_linux_close();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,468 @@
+/**
+ * @file hs_cfg.c
+ * @brief HeySalad T5 Terminal - Runtime configuration store
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#include "hs_cfg.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "heysalad_config.h"
+
+#define CFG_MAGIC           0x47464348  // "HCFG"
+#define CFG_MAX_SECTORS     16
+#define CFG_REC_MAX         1024
+#define CFG_ALIGN(n)        (((n) + 3U) & ~3U)
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;
+    uint16_t schema;
+    uint16_t len;           // TLV payload bytes, CRC follows
+} cfg_rec_hdr_t;
+
+typedef struct {
+    uint8_t key;
+    uint8_t type;
+    uint8_t secret;
+    const char *name;
+    uint16_t offset;
+    uint16_t size;
+    const char *def_str;
+    uint32_t def_u32;
+} cfg_item_t;
+
+#define CFG_STR(k, n, field, def, sec) \
+    { k, HS_CFG_TYPE_STR, sec, n, offsetof(hs_cfg_t, field), sizeof(((hs_cfg_t *)0)->field), def, 0 }
+#define CFG_U32(k, n, field, def) \
+    { k, HS_CFG_TYPE_U32, 0, n, offsetof(hs_cfg_t, field), sizeof(uint32_t), NULL, def }
+#define CFG_I32(k, n, field, def) \
+    { k, HS_CFG_TYPE_I32, 0, n, offsetof(hs_cfg_t, field), sizeof(int32_t), NULL, (uint32_t)(def) }
+
+// Schema: factory defaults come from heysalad_config.h
+static const cfg_item_t g_items[] = {
+    CFG_STR(HS_CFG_WIFI_SSID,   "wifi_ssid",   wifi_ssid,  WIFI_SSID,              0),
+    CFG_STR(HS_CFG_WIFI_PASS,   "wifi_pass",   wifi_pass,  WIFI_PASS,              1),
+    CFG_STR(HS_CFG_DEVICE_ID,   "device_id",   device_id,  TUYA_DEVICE_ID,         0),
+    CFG_STR(HS_CFG_DEVICE_KEY,  "device_key",  device_key, TUYA_DEVICE_KEY,        1),
+    CFG_STR(HS_CFG_BRIDGE_URL,  "bridge_url",  bridge_url, HEYSALAD_TUYA_BRIDGE,   0),
+    CFG_STR(HS_CFG_VOICE_URL,   "voice_url",   voice_url,  HEYSALAD_VOICE_AGENT,   0),
+    CFG_STR(HS_CFG_PAY_URL,     "pay_url",     pay_url,    HEYSALAD_PAYMENT_LINKS, 0),
+    CFG_STR(HS_CFG_CURRENCY,    "currency",    currency,   DEFAULT_CURRENCY,       0),
+    CFG_U32(HS_CFG_WIFI_TIMEOUT_MS, "wifi_timeout_ms", wifi_timeout_ms, WIFI_CONNECT_TIMEOUT_MS),
+    CFG_I32(HS_CFG_UTC_OFFSET_MIN,  "utc_offset_min",  utc_offset_min,  LOCAL_UTC_OFFSET_MIN),
+};
+
+#define CFG_ITEM_COUNT  (sizeof(g_items) / sizeof(g_items[0]))
+
+static const hs_flash_region_t *g_region = NULL;
+
+// Readers see g_live[g_cur]; a commit fills the other copy and flips
+static hs_cfg_t g_live[2];
+static volatile int g_cur = 0;
+static hs_cfg_t g_stage;
+
+// Append position in the ring
+static uint32_t g_sector = 0;
+static uint32_t g_tail = 0;
+static uint32_t g_seq = 0;
+
+static uint8_t g_rec[CFG_REC_MAX];
+
+static const cfg_item_t *item_by_key(uint8_t key)
+{
+    for (size_t i = 0; i < CFG_ITEM_COUNT; i++) {
+        if (g_items[i].key == key) {
+            return &g_items[i];
+        }
+    }
+    return NULL;
+}
+
+static const cfg_item_t *item_by_name(const char *name)
+{
+    for (size_t i = 0; i < CFG_ITEM_COUNT; i++) {
+        if (strcmp(g_items[i].name, name) == 0) {
+            return &g_items[i];
+        }
+    }
+    return NULL;
+}
+
+static void cfg_defaults(hs_cfg_t *cfg)
+{
+    memset(cfg, 0, sizeof(*cfg));
+    for (size_t i = 0; i < CFG_ITEM_COUNT; i++) {
+        const cfg_item_t *it = &g_items[i];
+        uint8_t *field = (uint8_t *)cfg + it->offset;
+        if (it->type == HS_CFG_TYPE_STR) {
+            snprintf((char *)field, it->size, "%s", it->def_str);
+        } else {
+            memcpy(field, &it->def_u32, sizeof(uint32_t));
+        }
+    }
+}
+
+/**
+ * @brief Upgrade values loaded from an older schema in place
+ */
+static void cfg_migrate(hs_cfg_t *cfg, uint16_t from)
+{
+    (void)cfg;
+    switch (from) {
+        // v1 is the first schema, nothing to migrate yet
+        default:
+            break;
+    }
+}
+
+// ============================================
+// Serialisation
+// ============================================
+
+static size_t cfg_encode(const hs_cfg_t *cfg, uint8_t *buf, size_t max)
+{
+    size_t pos = 0;
+
+    for (size_t i = 0; i < CFG_ITEM_COUNT; i++) {
+        const cfg_item_t *it = &g_items[i];
+        const uint8_t *field = (const uint8_t *)cfg + it->offset;
+        size_t len = it->type == HS_CFG_TYPE_STR ? strlen((const char *)field) : sizeof(uint32_t);
+
+        if (pos + 3 + len > max) {
+            return 0;
+        }
+        buf[pos++] = it->key;
+        buf[pos++] = it->type;
+        buf[pos++] = (uint8_t)len;
+        memcpy(&buf[pos], field, len);
+        pos += len;
+    }
+    return pos;
+}
+
+/**
+ * @brief Apply TLVs over cfg; unknown keys from newer schemas are skipped
+ */
+static void cfg_decode(hs_cfg_t *cfg, const uint8_t *buf, size_t len)
+{
+    size_t pos = 0;
+
+    while (pos + 3 <= len) {
+        uint8_t key = buf[pos];
+        uint8_t type = buf[pos + 1];
+        uint8_t vlen = buf[pos + 2];
+        const cfg_item_t *it = NULL;
+
+        pos += 3;
+        if (pos + vlen > len) {
+            break;
+        }
+        it = item_by_key(key);
+        if (it && it->type == type) {
+            uint8_t *field = (uint8_t *)cfg + it->offset;
+            if (type == HS_CFG_TYPE_STR && vlen < it->size) {
+                memcpy(field, &buf[pos], vlen);
+                field[vlen] = '\0';
+            } else if (type != HS_CFG_TYPE_STR && vlen == sizeof(uint32_t)) {
+                memcpy(field, &buf[pos], sizeof(uint32_t));
+            }
+        }
+        pos += vlen;
+    }
+}
+
+// ============================================
+// Flash ring
+// ============================================
+
+/**
+ * @brief Scan one sector, reporting its newest valid record and append offset
+ *
+ * A torn record ends the scan and marks the sector full, so nothing is
+ * ever appended behind bytes of unknown state.
+ */
+static void scan_sector(uint32_t sector, uint32_t *tail, uint32_t *best_seq,
+                        uint32_t *best_off, int *found)
+{
+    uint32_t base = sector * g_region->sector_size;
+    uint32_t off = 0;
+
+    *found = 0;
+    *tail = g_region->sector_size;
+
+    while (off + sizeof(cfg_rec_hdr_t) + sizeof(uint32_t) <= g_region->sector_size) {
+        cfg_rec_hdr_t hdr;
+        uint32_t crc = 0, stored = 0;
+        uint32_t need = 0;
+
+        if (hs_flash_read(g_region, base + off, &hdr, sizeof(hdr)) != 0) {
+            return;
+        }
+        if (hdr.magic == 0xFFFFFFFF) {
+            *tail = off;
+            return;
+        }
+        need = CFG_ALIGN(sizeof(hdr) + hdr.len + sizeof(uint32_t));
+        if (hdr.magic != CFG_MAGIC || hdr.len > CFG_REC_MAX || off + need > g_region->sector_size) {
+            return;
+        }
+        if (hs_flash_crc32(g_region, base + off, sizeof(hdr) + hdr.len, &crc) != 0 ||
+            hs_flash_read(g_region, base + off + sizeof(hdr) + hdr.len, &stored, sizeof(stored)) != 0 ||
+            crc != stored) {
+            return;
+        }
+        if (!*found || (int32_t)(hdr.seq - *best_seq) > 0) {
+            *found = 1;
+            *best_seq = hdr.seq;
+            *best_off = off;
+        }
+        off += need;
+    }
+}
+
+static int cfg_load(hs_cfg_t *cfg)
+{
+    uint32_t sectors = g_region->size / g_region->sector_size;
+    uint32_t tails[CFG_MAX_SECTORS];
+    int found = 0;
+    uint32_t best_sector = 0, best_off = 0, best_seq = 0;
+    cfg_rec_hdr_t hdr;
+
+    for (uint32_t s = 0; s < sectors; s++) {
+        uint32_t seq = 0, off = 0;
+        int ok = 0;
+
+        scan_sector(s, &tails[s], &seq, &off, &ok);
+        if (ok && (!found || (int32_t)(seq - best_seq) > 0)) {
+            found = 1;
+            best_seq = seq;
+            best_sector = s;
+            best_off = off;
+        }
+    }
+
+    cfg_defaults(cfg);
+    if (!found) {
+        g_sector = 0;
+        g_tail = tails[0];
+        g_seq = 0;
+        return -1;
+    }
+
+    g_sector = best_sector;
+    g_tail = tails[best_sector];
+    g_seq = best_seq;
+
+    best_off += best_sector * g_region->sector_size;
+    if (hs_flash_read(g_region, best_off, &hdr, sizeof(hdr)) != 0 ||
+        hs_flash_read(g_region, best_off + sizeof(hdr), g_rec, hdr.len) != 0) {
+        return -1;
+    }
+    cfg_decode(cfg, g_rec, hdr.len);
+    if (hdr.schema < HS_CFG_SCHEMA_VERSION) {
+        cfg_migrate(cfg, hdr.schema);
+    }
+    return 0;
+}
+
+static int cfg_store(const hs_cfg_t *cfg)
+{
+    cfg_rec_hdr_t hdr = { CFG_MAGIC, g_seq + 1, HS_CFG_SCHEMA_VERSION, 0 };
+    uint32_t sectors = g_region->size / g_region->sector_size;
+    uint32_t need = 0, addr = 0, crc = 0;
+    size_t len = cfg_encode(cfg, g_rec, sizeof(g_rec));
+
+    if (len == 0) {
+        return -1;
+    }
+    hdr.len = (uint16_t)len;
+    need = CFG_ALIGN(sizeof(hdr) + len + sizeof(uint32_t));
+
+    // Move on to the next sector; the newest snapshot is never the one erased
+    if (g_tail + need > g_region->sector_size) {
+        g_sector = (g_sector + 1) % sectors;
+        g_tail = 0;
+        if (hs_flash_erase(g_region, g_sector * g_region->sector_size, g_region->sector_size) != 0) {
+            g_tail = g_region->sector_size;
+            return -1;
+        }
+    }
+
+    crc = hs_crc32(crc, &hdr, sizeof(hdr));
+    crc = hs_crc32(crc, g_rec, len);
+    addr = g_sector * g_region->sector_size + g_tail;
+
+    // Whatever happens below, this space is consumed
+    g_tail += need;
+    if (hs_flash_write(g_region, addr, &hdr, sizeof(hdr)) != 0 ||
+        hs_flash_write(g_region, addr + sizeof(hdr), g_rec, len) != 0 ||
+        hs_flash_write(g_region, addr + sizeof(hdr) + len, &crc, sizeof(crc)) != 0) {
+        return -1;
+    }
+    g_seq = hdr.seq;
+    return 0;
+}
+
+// ============================================
+// Public API
+// ============================================
+
+int hs_cfg_init(const hs_flash_region_t *region)
+{
+    int rt = -1;
+
+    if (!region || region->sector_size == 0 ||
+        region->size / region->sector_size < 2 ||
+        region->size / region->sector_size > CFG_MAX_SECTORS) {
+        cfg_defaults(&g_live[0]);
+        g_cur = 0;
+        memcpy(&g_stage, &g_live[0], sizeof(g_stage));
+        return -1;
+    }
+
+    g_region = region;
+    rt = cfg_load(&g_live[0]);
+    g_cur = 0;
+    memcpy(&g_stage, &g_live[0], sizeof(g_stage));
+    return rt;
+}
+
+const hs_cfg_t *hs_cfg(void)
+{
+    return &g_live[g_cur];
+}
+
+int hs_cfg_set(const char *name, const char *value)
+{
+    const cfg_item_t *it = item_by_name(name);
+    uint8_t *field = NULL;
+
+    if (!it || !value) {
+        return -1;
+    }
+    field = (uint8_t *)&g_stage + it->offset;
+
+    if (it->type == HS_CFG_TYPE_STR) {
+        if (strlen(value) >= it->size) {
+            return -1;
+        }
+        memset(field, 0, it->size);
+        memcpy(field, value, strlen(value));
+    } else {
+        char *end = NULL;
+        uint32_t u = it->type == HS_CFG_TYPE_I32 ? (uint32_t)strtol(value, &end, 0) :
+                                                   (uint32_t)strtoul(value, &end, 0);
+        if (end == value || *end != '\0') {
+            return -1;
+        }
+        memcpy(field, &u, sizeof(u));
+    }
+    return 0;
+}
+
+int hs_cfg_get(const char *name, char *out, size_t out_len)
+{
+    const cfg_item_t *it = item_by_name(name);
+    const uint8_t *field = NULL;
+
+    if (!it || !out || out_len == 0) {
+        return -1;
+    }
+    field = (const uint8_t *)hs_cfg() + it->offset;
+
+    if (it->type == HS_CFG_TYPE_STR) {
+        const char *s = (const char *)field;
+        snprintf(out, out_len, "%s", (it->secret && s[0]) ? "********" : s);
+    } else {
+        uint32_t u = 0;
+        memcpy(&u, field, sizeof(u));
+        if (it->type == HS_CFG_TYPE_I32) {
+            snprintf(out, out_len, "%d", (int)(int32_t)u);
+        } else {
+            snprintf(out, out_len, "%u", (unsigned)u);
+        }
+    }
+    return 0;
+}
+
+void hs_cfg_reset(void)
+{
+    cfg_defaults(&g_stage);
+}
+
+int hs_cfg_commit(void)
+{
+    int next = g_cur ^ 1;
+
+    if (!g_region || cfg_store(&g_stage) != 0) {
+        return -1;
+    }
+    memcpy(&g_live[next], &g_stage, sizeof(g_stage));
+    g_cur = next;
+    return 0;
+}
+
+int hs_cfg_provision_line(const char *line, char *out, size_t out_len)
+{
+    char buf[192];
+    char *cmd = NULL, *name = NULL, *value = NULL;
+    size_t len = 0;
+
+    if (strncmp(line, "cfg", 3) != 0 || (line[3] != ' ' && line[3] != '\0' &&
+                                         line[3] != '\r' && line[3] != '\n')) {
+        return -1;
+    }
+
+    strncpy(buf, line, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+    len = strlen(buf);
+    while (len > 0 && (buf[len - 1] == '\r' || buf[len - 1] == '\n')) {
+        buf[--len] = '\0';
+    }
+
+    // "cfg <cmd> [name] [value...]", value keeps its inner spaces
+    cmd = strchr(buf, ' ');
+    if (cmd) {
+        *cmd++ = '\0';
+        name = strchr(cmd, ' ');
+        if (name) {
+            *name++ = '\0';
+            value = strchr(name, ' ');
+            if (value) {
+                *value++ = '\0';
+            }
+        }
+    }
+
+    if (!cmd || strcmp(cmd, "get") == 0) {
+        size_t pos = 0;
+        out[0] = '\0';
+        for (size_t i = 0; i < CFG_ITEM_COUNT && pos < out_len; i++) {
+            char v[130];
+            if (name && strcmp(name, g_items[i].name) != 0) {
+                continue;
+            }
+            hs_cfg_get(g_items[i].name, v, sizeof(v));
+            pos += snprintf(out + pos, out_len - pos, "%s=%s\n", g_items[i].name, v);
+        }
+        if (out[0] == '\0') {
+            snprintf(out, out_len, "ERR unknown key\n");
+        }
+    } else if (strcmp(cmd, "set") == 0) {
+        snprintf(out, out_len, (name && value && hs_cfg_set(name, value) == 0) ?
+                 "OK\n" : "ERR bad key or value\n");
+    } else if (strcmp(cmd, "reset") == 0) {
+        hs_cfg_reset();
+        snprintf(out, out_len, "OK defaults staged\n");
+    } else if (strcmp(cmd, "commit") == 0) {
+        snprintf(out, out_len, hs_cfg_commit() == 0 ? "OK\n" : "ERR flash\n");
+    } else {
+        snprintf(out, out_len, "ERR usage: cfg get|set|reset|commit\n");
+    }
+    return 0;
+}
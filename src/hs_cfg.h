@@ -0,0 +1,111 @@
+/**
+ * @file hs_cfg.h
+ * @brief HeySalad T5 Terminal - Runtime configuration store
+ *
+ * Credentials and endpoints live in flash instead of the firmware image,
+ * so one build serves the whole fleet. The compile-time macros in
+ * heysalad_config.h are only the factory defaults.
+ *
+ * Storage is a ring of sectors holding complete, CRC protected snapshots.
+ * A commit appends a new snapshot (and erases the next sector when the
+ * current one is full), so the previous snapshot stays valid until the new
+ * one is fully written and wear spreads over the whole ring.
+ *
+ * The loaded values are kept in a plain struct; readers take the pointer
+ * from hs_cfg() and never parse flash at run time.
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#ifndef HS_CFG_H
+#define HS_CFG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hs_flash.h"
+
+#define HS_CFG_SCHEMA_VERSION   1
+
+// Key ids are stored in flash: never renumber, only append
+typedef enum {
+    HS_CFG_WIFI_SSID = 1,
+    HS_CFG_WIFI_PASS,
+    HS_CFG_DEVICE_ID,
+    HS_CFG_DEVICE_KEY,
+    HS_CFG_BRIDGE_URL,
+    HS_CFG_VOICE_URL,
+    HS_CFG_PAY_URL,
+    HS_CFG_CURRENCY,
+    HS_CFG_WIFI_TIMEOUT_MS,
+    HS_CFG_UTC_OFFSET_MIN,
+    HS_CFG_KEY_MAX
+} hs_cfg_key_t;
+
+typedef enum {
+    HS_CFG_TYPE_STR = 1,
+    HS_CFG_TYPE_U32,
+    HS_CFG_TYPE_I32,
+} hs_cfg_type_t;
+
+/**
+ * @brief Read-optimised view of the configuration
+ */
+typedef struct {
+    char wifi_ssid[33];
+    char wifi_pass[65];
+    char device_id[33];
+    char device_key[49];
+    char bridge_url[128];
+    char voice_url[128];
+    char pay_url[128];
+    char currency[4];
+    uint32_t wifi_timeout_ms;
+    int32_t utc_offset_min;     // Local time, for "today" in ledger queries
+} hs_cfg_t;
+
+/**
+ * @brief Load the newest snapshot from region, falling back to defaults
+ */
+int hs_cfg_init(const hs_flash_region_t *region);
+
+/**
+ * @brief Current configuration, valid until the next hs_cfg_commit()
+ */
+const hs_cfg_t *hs_cfg(void);
+
+/**
+ * @brief Stage a value by name, parsed according to its type
+ */
+int hs_cfg_set(const char *name, const char *value);
+
+/**
+ * @brief Format a value by name, secrets are masked
+ */
+int hs_cfg_get(const char *name, char *out, size_t out_len);
+
+/**
+ * @brief Reset the staged copy to factory defaults
+ */
+void hs_cfg_reset(void);
+
+/**
+ * @brief Atomically persist the staged copy and make it current
+ */
+int hs_cfg_commit(void);
+
+/**
+ * @brief Handle one provisioning command line
+ *
+ * Transport independent: fed from the serial console, or from any other
+ * channel delivering text lines. Commands:
+ *   cfg get [name]       list one or all values
+ *   cfg set <name> <v>   stage a value
+ *   cfg reset            stage factory defaults
+ *   cfg commit           persist staged values
+ *
+ * @return 0 if the line was a cfg command (reply written to out), -1 if not
+ */
+int hs_cfg_provision_line(const char *line, char *out, size_t out_len);
+
+#endif // HS_CFG_H
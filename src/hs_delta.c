@@ -0,0 +1,417 @@
+/**
+ * @file hs_delta.c
+ * @brief HeySalad T5 Terminal - Streaming delta patch decoder
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#include "hs_delta.h"
+
+#include <string.h>
+
+// LZSS decoder states
+enum {
+    LZ_TAG = 0,
+    LZ_LITERAL,
+    LZ_INDEX,
+    LZ_COUNT,
+    LZ_COPY,
+};
+
+// Patch op states
+enum {
+    OP_CTRL = 0,
+    OP_DIFF,
+    OP_EXTRA,
+    OP_DONE,
+};
+
+static uint32_t get_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// ============================================
+// LZSS (heatshrink compatible) decoder
+// ============================================
+
+/**
+ * @brief Collect count bits MSB first, returns 0 when input ran dry
+ */
+static int lz_get_bits(hs_delta_state_t *st, uint8_t count, uint16_t *out)
+{
+    while (st->acc_bits < count) {
+        if (st->in_bits == 0) {
+            return 0;
+        }
+        st->in_bits--;
+        st->acc = (uint16_t)((st->acc << 1) | ((st->in_byte >> st->in_bits) & 1));
+        st->acc_bits++;
+    }
+    *out = st->acc;
+    st->acc = 0;
+    st->acc_bits = 0;
+    return 1;
+}
+
+static void lz_push(hs_delta_state_t *st, uint8_t c)
+{
+    uint16_t mask = (uint16_t)((1U << st->hdr.window_sz2) - 1);
+    st->window[st->head & mask] = c;
+    st->head++;
+}
+
+/**
+ * @brief Produce the next decompressed byte, returns 0 when input ran dry
+ */
+static int lz_next(hs_delta_state_t *st, uint8_t *out)
+{
+    uint16_t v = 0;
+
+    for (;;) {
+        switch (st->lz_state) {
+            case LZ_TAG:
+                if (!lz_get_bits(st, 1, &v)) {
+                    return 0;
+                }
+                st->lz_state = v ? LZ_LITERAL : LZ_INDEX;
+                break;
+
+            case LZ_LITERAL:
+                if (!lz_get_bits(st, 8, &v)) {
+                    return 0;
+                }
+                *out = (uint8_t)v;
+                lz_push(st, *out);
+                st->lz_state = LZ_TAG;
+                return 1;
+
+            case LZ_INDEX:
+                if (!lz_get_bits(st, st->hdr.window_sz2, &v)) {
+                    return 0;
+                }
+                st->copy_index = (uint16_t)(v + 1);
+                st->lz_state = LZ_COUNT;
+                break;
+
+            case LZ_COUNT:
+                if (!lz_get_bits(st, st->hdr.lookahead_sz2, &v)) {
+                    return 0;
+                }
+                st->copy_left = (uint16_t)(v + 1);
+                st->lz_state = LZ_COPY;
+                break;
+
+            case LZ_COPY: {
+                uint16_t mask = (uint16_t)((1U << st->hdr.window_sz2) - 1);
+                *out = st->window[(uint16_t)(st->head - st->copy_index) & mask];
+                lz_push(st, *out);
+                if (--st->copy_left == 0) {
+                    st->lz_state = LZ_TAG;
+                }
+                return 1;
+            }
+
+            default:
+                return 0;
+        }
+    }
+}
+
+// ============================================
+// Flash output
+// ============================================
+
+static int old_byte(hs_delta_t *d, uint32_t pos, uint8_t *out)
+{
+    if (pos < d->old_cache_pos || pos >= d->old_cache_pos + d->old_cache_len) {
+        uint32_t n = d->st.hdr.old_size - pos;
+        if (n > sizeof(d->old_cache)) {
+            n = sizeof(d->old_cache);
+        }
+        if (hs_flash_read(d->old_img, pos, d->old_cache, n) != 0) {
+            d->old_cache_len = 0;
+            return HS_DELTA_ERR_FLASH;
+        }
+        d->old_cache_pos = pos;
+        d->old_cache_len = (uint16_t)n;
+    }
+    *out = d->old_cache[pos - d->old_cache_pos];
+    return HS_DELTA_OK;
+}
+
+static int flush_page(hs_delta_t *d)
+{
+    hs_delta_state_t *st = &d->st;
+    uint32_t sector = d->new_img->sector_size;
+    uint32_t addr = st->new_pos - st->page_fill;
+
+    if ((addr % sector) == 0) {
+        if (hs_flash_erase(d->new_img, addr, sector) != 0) {
+            return HS_DELTA_ERR_FLASH;
+        }
+    }
+    if (hs_flash_write(d->new_img, addr, st->page, st->page_fill) != 0) {
+        return HS_DELTA_ERR_FLASH;
+    }
+    st->page_fill = 0;
+
+    // Sector complete: nothing is buffered, a good point to persist state
+    if ((st->new_pos % sector) == 0 && st->new_pos < st->hdr.new_size && d->checkpoint) {
+        if (d->checkpoint(d->checkpoint_arg, st) != 0) {
+            return HS_DELTA_ERR_FLASH;
+        }
+    }
+    return HS_DELTA_OK;
+}
+
+static int finish(hs_delta_t *d)
+{
+    hs_delta_state_t *st = &d->st;
+    uint32_t crc = 0;
+
+    if (st->new_crc != st->hdr.new_crc) {
+        return HS_DELTA_ERR_VERIFY;
+    }
+    // Read back what actually landed in flash before anyone boots it
+    if (hs_flash_crc32(d->new_img, 0, st->hdr.new_size, &crc) != 0) {
+        return HS_DELTA_ERR_FLASH;
+    }
+    if (crc != st->hdr.new_crc) {
+        return HS_DELTA_ERR_VERIFY;
+    }
+    st->op = OP_DONE;
+    return HS_DELTA_DONE;
+}
+
+static int emit(hs_delta_t *d, uint8_t c)
+{
+    hs_delta_state_t *st = &d->st;
+
+    st->page[st->page_fill++] = c;
+    st->new_crc = hs_crc32(st->new_crc, &c, 1);
+    st->new_pos++;
+
+    if (st->page_fill == HS_DELTA_PAGE_SIZE || st->new_pos == st->hdr.new_size) {
+        return flush_page(d);
+    }
+    return HS_DELTA_OK;
+}
+
+// ============================================
+// Patch ops
+// ============================================
+
+/**
+ * @brief Close the current op; runs before its last byte is emitted so a
+ *        checkpoint taken during that emit already sees the next op
+ */
+static int op_end(hs_delta_state_t *st)
+{
+    int64_t pos = (int64_t)st->old_pos + st->seek;
+
+    if (pos < 0 || pos > (int64_t)st->hdr.old_size) {
+        return HS_DELTA_ERR_FORMAT;
+    }
+    st->old_pos = (uint32_t)pos;
+    st->op = OP_CTRL;
+    st->ctrl_len = 0;
+    return HS_DELTA_OK;
+}
+
+static int op_emit(hs_delta_t *d, uint8_t c)
+{
+    int rt = emit(d, c);
+
+    if (rt == HS_DELTA_OK && d->st.new_pos == d->st.hdr.new_size) {
+        rt = finish(d);
+    }
+    return rt;
+}
+
+static int op_byte(hs_delta_t *d, uint8_t c)
+{
+    hs_delta_state_t *st = &d->st;
+    uint8_t old = 0;
+    int rt = HS_DELTA_OK;
+
+    switch (st->op) {
+        case OP_CTRL:
+            st->ctrl[st->ctrl_len++] = c;
+            if (st->ctrl_len < HS_DELTA_CTRL_SIZE) {
+                return HS_DELTA_OK;
+            }
+            st->diff_left = get_le32(&st->ctrl[0]);
+            st->extra_left = get_le32(&st->ctrl[4]);
+            st->seek = (int32_t)get_le32(&st->ctrl[8]);
+
+            if (st->diff_left > st->hdr.new_size - st->new_pos ||
+                st->extra_left > st->hdr.new_size - st->new_pos - st->diff_left ||
+                st->diff_left > st->hdr.old_size - st->old_pos) {
+                return HS_DELTA_ERR_FORMAT;
+            }
+            if (st->diff_left > 0) {
+                st->op = OP_DIFF;
+            } else if (st->extra_left > 0) {
+                st->op = OP_EXTRA;
+            } else {
+                return op_end(st);
+            }
+            return HS_DELTA_OK;
+
+        case OP_DIFF:
+            rt = old_byte(d, st->old_pos, &old);
+            if (rt != HS_DELTA_OK) {
+                return rt;
+            }
+            st->old_pos++;
+            if (--st->diff_left == 0) {
+                if (st->extra_left > 0) {
+                    st->op = OP_EXTRA;
+                } else if ((rt = op_end(st)) != HS_DELTA_OK) {
+                    return rt;
+                }
+            }
+            return op_emit(d, (uint8_t)(old + c));
+
+        case OP_EXTRA:
+            if (--st->extra_left == 0) {
+                if ((rt = op_end(st)) != HS_DELTA_OK) {
+                    return rt;
+                }
+            }
+            return op_emit(d, c);
+
+        case OP_DONE:
+            return HS_DELTA_DONE;
+
+        default:
+            return HS_DELTA_ERR_FORMAT;
+    }
+}
+
+// ============================================
+// Public API
+// ============================================
+
+static int parse_header(hs_delta_t *d)
+{
+    hs_delta_state_t *st = &d->st;
+    uint32_t crc = 0;
+
+    hs_delta_read_header(st->hdr_buf, &st->hdr);
+
+    if (st->hdr.magic != HS_DELTA_MAGIC ||
+        st->hdr.window_sz2 < 4 || st->hdr.window_sz2 > HS_DELTA_WINDOW_SZ2_MAX ||
+        st->hdr.lookahead_sz2 < 3 || st->hdr.lookahead_sz2 >= st->hdr.window_sz2 ||
+        st->hdr.new_size == 0 || st->hdr.new_size > d->new_img->size ||
+        st->hdr.old_size > d->old_img->size) {
+        return HS_DELTA_ERR_FORMAT;
+    }
+
+    // A delta only makes sense against the exact image it was built from
+    if (hs_flash_crc32(d->old_img, 0, st->hdr.old_size, &crc) != 0) {
+        return HS_DELTA_ERR_FLASH;
+    }
+    if (crc != st->hdr.old_crc) {
+        return HS_DELTA_ERR_BASE;
+    }
+    return HS_DELTA_OK;
+}
+
+void hs_delta_read_header(const uint8_t *buf, hs_delta_header_t *hdr)
+{
+    hdr->magic = get_le32(&buf[0]);
+    hdr->window_sz2 = buf[4];
+    hdr->lookahead_sz2 = buf[5];
+    hdr->reserved = (uint16_t)(buf[6] | (buf[7] << 8));
+    hdr->old_size = get_le32(&buf[8]);
+    hdr->old_crc = get_le32(&buf[12]);
+    hdr->new_size = get_le32(&buf[16]);
+    hdr->new_crc = get_le32(&buf[20]);
+}
+
+int hs_delta_init(hs_delta_t *d, const hs_flash_region_t *old_img, const hs_flash_region_t *new_img,
+                  hs_delta_checkpoint_cb checkpoint, void *checkpoint_arg)
+{
+    if (!d || !old_img || !new_img || new_img->sector_size == 0 ||
+        (new_img->sector_size % HS_DELTA_PAGE_SIZE) != 0) {
+        return HS_DELTA_ERR_PARAM;
+    }
+    memset(d, 0, sizeof(*d));
+    d->st.magic = HS_DELTA_MAGIC;
+    d->old_img = old_img;
+    d->new_img = new_img;
+    d->checkpoint = checkpoint;
+    d->checkpoint_arg = checkpoint_arg;
+    return HS_DELTA_OK;
+}
+
+int hs_delta_resume(hs_delta_t *d, const hs_delta_state_t *saved)
+{
+    if (!d || !saved || saved->magic != HS_DELTA_MAGIC ||
+        saved->hdr_len != HS_DELTA_HEADER_SIZE || saved->page_fill != 0 ||
+        (saved->new_pos % d->new_img->sector_size) != 0 ||
+        saved->hdr.new_size > d->new_img->size) {
+        return HS_DELTA_ERR_PARAM;
+    }
+    memcpy(&d->st, saved, sizeof(d->st));
+    d->old_cache_len = 0;
+    return HS_DELTA_OK;
+}
+
+int hs_delta_feed(hs_delta_t *d, const uint8_t *data, size_t len)
+{
+    hs_delta_state_t *st = &d->st;
+    size_t i = 0;
+    uint8_t c = 0;
+    int rt = HS_DELTA_OK;
+
+    if (st->op == OP_DONE) {
+        return HS_DELTA_DONE;
+    }
+
+    // Header
+    while (st->hdr_len < HS_DELTA_HEADER_SIZE && i < len) {
+        st->hdr_buf[st->hdr_len++] = data[i++];
+        st->in_offset++;
+        if (st->hdr_len == HS_DELTA_HEADER_SIZE) {
+            rt = parse_header(d);
+            if (rt != HS_DELTA_OK) {
+                return rt;
+            }
+        }
+    }
+
+    if (st->hdr_len < HS_DELTA_HEADER_SIZE) {
+        return HS_DELTA_OK;
+    }
+
+    // Compressed ops, starting with any bits or back-reference copy left
+    // over from a resumed checkpoint
+    for (;;) {
+        while (lz_next(st, &c)) {
+            rt = op_byte(d, c);
+            if (rt != HS_DELTA_OK) {
+                return rt;
+            }
+        }
+        if (i >= len) {
+            break;
+        }
+        st->in_byte = data[i++];
+        st->in_bits = 8;
+        st->in_offset++;
+    }
+    return HS_DELTA_OK;
+}
+
+uint32_t hs_delta_offset(const hs_delta_t *d)
+{
+    return d->st.in_offset;
+}
+
+const hs_delta_header_t *hs_delta_header(const hs_delta_t *d)
+{
+    return &d->st.hdr;
+}
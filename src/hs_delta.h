@@ -0,0 +1,153 @@
+/**
+ * @file hs_delta.h
+ * @brief HeySalad T5 Terminal - Streaming delta patch decoder
+ *
+ * Applies a compressed binary delta against the running image and writes
+ * the result straight into another flash region, with a fixed RAM budget
+ * (decompression window + one program page) independent of image size.
+ *
+ * Patch stream layout:
+ *   - hs_delta_header_t, uncompressed, little endian
+ *   - LZSS bit stream (heatshrink format, window_sz2 / lookahead_sz2 from
+ *     the header) which decompresses to a sequence of bsdiff style ops:
+ *       u32 diff_len, u32 extra_len, i32 seek   (little endian)
+ *       diff_len bytes   added (mod 256) to the old image at old_pos
+ *       extra_len bytes  copied verbatim
+ *     after each op old_pos += seek.
+ *
+ * Decoding is resumable: every time a flash sector of the new image is
+ * complete, the checkpoint callback receives the whole decoder state. Feed
+ * that back through hs_delta_resume() and continue downloading the patch
+ * from hs_delta_offset().
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#ifndef HS_DELTA_H
+#define HS_DELTA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hs_flash.h"
+
+#define HS_DELTA_MAGIC              0x31445348  // "HSD1"
+#define HS_DELTA_HEADER_SIZE        24
+#define HS_DELTA_WINDOW_SZ2_MAX     10          // 1 KB decompression window
+#define HS_DELTA_PAGE_SIZE          256         // Flash program granularity
+#define HS_DELTA_CTRL_SIZE          12
+
+// Return codes
+#define HS_DELTA_OK                 0           // Need more input
+#define HS_DELTA_DONE               1           // Image written and verified
+#define HS_DELTA_ERR_PARAM          -1
+#define HS_DELTA_ERR_FORMAT         -2          // Corrupt or unsupported patch
+#define HS_DELTA_ERR_BASE           -3          // Patch is not for the running image
+#define HS_DELTA_ERR_FLASH          -4
+#define HS_DELTA_ERR_VERIFY         -5          // Written image CRC mismatch
+
+typedef struct {
+    uint32_t magic;
+    uint8_t  window_sz2;
+    uint8_t  lookahead_sz2;
+    uint16_t reserved;
+    uint32_t old_size;
+    uint32_t old_crc;
+    uint32_t new_size;
+    uint32_t new_crc;
+} hs_delta_header_t;
+
+/**
+ * @brief Complete decoder state, plain data so it can be persisted as is
+ */
+typedef struct {
+    uint32_t magic;             // HS_DELTA_MAGIC once initialised
+    uint32_t in_offset;         // Patch bytes consumed, header included
+    uint8_t  hdr_buf[HS_DELTA_HEADER_SIZE];
+    uint8_t  hdr_len;
+    hs_delta_header_t hdr;
+
+    // LZSS decoder
+    uint8_t  lz_state;
+    uint8_t  in_byte;
+    uint8_t  in_bits;           // Unread bits left in in_byte
+    uint8_t  acc_bits;
+    uint16_t acc;
+    uint16_t copy_index;
+    uint16_t copy_left;
+    uint16_t head;
+    uint8_t  window[1 << HS_DELTA_WINDOW_SZ2_MAX];
+
+    // Patch ops
+    uint8_t  op;
+    uint8_t  ctrl_len;
+    uint8_t  ctrl[HS_DELTA_CTRL_SIZE];
+    uint32_t diff_left;
+    uint32_t extra_left;
+    int32_t  seek;
+    uint32_t old_pos;
+    uint32_t new_pos;
+    uint32_t new_crc;           // Running CRC of bytes emitted so far
+
+    // Output page, always empty at a checkpoint
+    uint16_t page_fill;
+    uint8_t  page[HS_DELTA_PAGE_SIZE];
+} hs_delta_state_t;
+
+typedef int (*hs_delta_checkpoint_cb)(void *arg, const hs_delta_state_t *state);
+
+typedef struct {
+    hs_delta_state_t st;
+    const hs_flash_region_t *old_img;
+    const hs_flash_region_t *new_img;
+    hs_delta_checkpoint_cb checkpoint;
+    void *checkpoint_arg;
+
+    // Read cache over the old image, rebuilt on demand
+    uint32_t old_cache_pos;
+    uint16_t old_cache_len;
+    uint8_t  old_cache[64];
+} hs_delta_t;
+
+/**
+ * @brief Decode the HS_DELTA_HEADER_SIZE bytes at the start of a patch
+ *
+ * No validation, for comparing a patch against a saved checkpoint.
+ */
+void hs_delta_read_header(const uint8_t *buf, hs_delta_header_t *hdr);
+
+/**
+ * @brief Start a fresh decode from old_img into new_img
+ *
+ * new_img sector_size must be a multiple of HS_DELTA_PAGE_SIZE.
+ * checkpoint may be NULL when resuming is not needed.
+ */
+int hs_delta_init(hs_delta_t *d, const hs_flash_region_t *old_img, const hs_flash_region_t *new_img,
+                  hs_delta_checkpoint_cb checkpoint, void *checkpoint_arg);
+
+/**
+ * @brief Continue from a state previously handed to the checkpoint callback
+ *
+ * Call after hs_delta_init() with the same regions.
+ */
+int hs_delta_resume(hs_delta_t *d, const hs_delta_state_t *saved);
+
+/**
+ * @brief Feed the next chunk of the patch stream
+ *
+ * @return HS_DELTA_OK for more input, HS_DELTA_DONE when the new image is
+ *         complete and verified, or a negative HS_DELTA_ERR_* code
+ */
+int hs_delta_feed(hs_delta_t *d, const uint8_t *data, size_t len);
+
+/**
+ * @brief Offset in the patch stream of the next byte hs_delta_feed() expects
+ */
+uint32_t hs_delta_offset(const hs_delta_t *d);
+
+/**
+ * @brief Patch header, valid once hs_delta_offset() >= HS_DELTA_HEADER_SIZE
+ */
+const hs_delta_header_t *hs_delta_header(const hs_delta_t *d);
+
+#endif // HS_DELTA_H
@@ -0,0 +1,84 @@
+/**
+ * @file hs_flash.c
+ * @brief HeySalad T5 Terminal - Flash region abstraction
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#include "hs_flash.h"
+
+static int region_check(const hs_flash_region_t *region, uint32_t offset, size_t len)
+{
+    if (!region || !region->ops) {
+        return -1;
+    }
+    if (offset > region->size || len > region->size - offset) {
+        return -1;
+    }
+    return 0;
+}
+
+int hs_flash_read(const hs_flash_region_t *region, uint32_t offset, void *buf, size_t len)
+{
+    if (region_check(region, offset, len) != 0) {
+        return -1;
+    }
+    return region->ops->read(region->ctx, region->base + offset, (uint8_t *)buf, len);
+}
+
+int hs_flash_write(const hs_flash_region_t *region, uint32_t offset, const void *buf, size_t len)
+{
+    if (region_check(region, offset, len) != 0) {
+        return -1;
+    }
+    return region->ops->write(region->ctx, region->base + offset, (const uint8_t *)buf, len);
+}
+
+int hs_flash_erase(const hs_flash_region_t *region, uint32_t offset, size_t len)
+{
+    if (region_check(region, offset, len) != 0) {
+        return -1;
+    }
+    if ((offset % region->sector_size) != 0 || (len % region->sector_size) != 0) {
+        return -1;
+    }
+    return region->ops->erase(region->ctx, region->base + offset, len);
+}
+
+uint32_t hs_crc32(uint32_t crc, const void *data, size_t len)
+{
+    // Nibble table: 64 bytes of rodata instead of 1 KB
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+        0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+        0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    const uint8_t *p = (const uint8_t *)data;
+
+    crc = ~crc;
+    while (len--) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+int hs_flash_crc32(const hs_flash_region_t *region, uint32_t offset, size_t len, uint32_t *crc)
+{
+    uint8_t buf[128];
+    uint32_t c = 0;
+
+    while (len > 0) {
+        size_t n = len < sizeof(buf) ? len : sizeof(buf);
+        if (hs_flash_read(region, offset, buf, n) != 0) {
+            return -1;
+        }
+        c = hs_crc32(c, buf, n);
+        offset += n;
+        len -= n;
+    }
+    *crc = c;
+    return 0;
+}
@@ -0,0 +1,63 @@
+/**
+ * @file hs_flash.h
+ * @brief HeySalad T5 Terminal - Flash region abstraction
+ *
+ * A flash region is a window [base, base + size) of a NOR flash device,
+ * accessed through a small ops table so that storage code (OTA slots,
+ * persistent records) never calls the platform flash driver directly.
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#ifndef HS_FLASH_H
+#define HS_FLASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Low level flash operations, addresses are absolute device addresses
+ */
+typedef struct {
+    int (*read)(void *ctx, uint32_t addr, uint8_t *buf, size_t len);
+    int (*write)(void *ctx, uint32_t addr, const uint8_t *buf, size_t len);
+    int (*erase)(void *ctx, uint32_t addr, size_t len);
+} hs_flash_ops_t;
+
+/**
+ * @brief A sector aligned window of a flash device
+ */
+typedef struct {
+    const hs_flash_ops_t *ops;
+    void *ctx;
+    uint32_t base;          // Absolute start address, sector aligned
+    uint32_t size;          // Region size in bytes, multiple of sector_size
+    uint32_t sector_size;   // Erase granularity
+} hs_flash_region_t;
+
+/**
+ * @brief Read from a region, offset is relative to region base
+ */
+int hs_flash_read(const hs_flash_region_t *region, uint32_t offset, void *buf, size_t len);
+
+/**
+ * @brief Program previously erased bytes, offset is relative to region base
+ */
+int hs_flash_write(const hs_flash_region_t *region, uint32_t offset, const void *buf, size_t len);
+
+/**
+ * @brief Erase whole sectors, offset and len must be sector aligned
+ */
+int hs_flash_erase(const hs_flash_region_t *region, uint32_t offset, size_t len);
+
+/**
+ * @brief CRC-32 (IEEE 802.3), pass 0 as crc to start a new checksum
+ */
+uint32_t hs_crc32(uint32_t crc, const void *data, size_t len);
+
+/**
+ * @brief CRC-32 over a region range, read through a small stack buffer
+ */
+int hs_flash_crc32(const hs_flash_region_t *region, uint32_t offset, size_t len, uint32_t *crc);
+
+#endif // HS_FLASH_H
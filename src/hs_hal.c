@@ -0,0 +1,37 @@
+/**
+ * @file hs_hal.c
+ * @brief HeySalad T5 Terminal - Hardware abstraction layer
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#include "hs_hal.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+static const hs_hal_t *g_hal = NULL;
+
+void hs_hal_set(const hs_hal_t *hal)
+{
+    g_hal = hal;
+}
+
+const hs_hal_t *hs_hal(void)
+{
+    return g_hal;
+}
+
+void hs_log(hs_log_level_t level, const char *fmt, ...)
+{
+    char line[256];
+    va_list ap;
+
+    if (!g_hal || !g_hal->log) {
+        return;
+    }
+    va_start(ap, fmt);
+    vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    g_hal->log(level, line);
+}
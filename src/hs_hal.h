@@ -0,0 +1,130 @@
+/**
+ * @file hs_hal.h
+ * @brief HeySalad T5 Terminal - Hardware abstraction layer
+ *
+ * Everything the terminal core needs from the platform, as one table of
+ * function pointers. tuya_main.c fills it in for the T5AI-Core; the host
+ * backend in host/ fills it in for Linux, with flash kept in a file.
+ *
+ * Events flow the other way: the backend reports button edges and link
+ * changes through hs_terminal_button() / hs_terminal_link() and then
+ * wakes whatever wait_event() is blocked on.
+ *
+ * Optional entries may be NULL, the core skips that feature.
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#ifndef HS_HAL_H
+#define HS_HAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hs_flash.h"
+#include "hs_power.h"
+
+typedef enum {
+    HS_LED_IDLE = 0,
+    HS_LED_LISTENING,
+    HS_LED_PROCESSING,
+    HS_LED_SUCCESS,
+    HS_LED_ERROR
+} hs_led_t;
+
+typedef enum {
+    HS_PART_APP = 0,            // Running firmware as installed, read only
+    HS_PART_OTA,                // Package slots owned by the terminal, see hs_ota.h
+    HS_PART_DATA,               // Terminal records: OTA state, config, ledger
+    HS_PART_MAX
+} hs_part_t;
+
+typedef struct {
+    int status;                 // HTTP status code
+    int has_range;              // Content-Range header present
+    uint32_t range_start;       // First byte position it names
+} hs_http_head_t;
+
+typedef enum {
+    HS_LOG_ERR = 0,
+    HS_LOG_INFO,
+    HS_LOG_DEBUG
+} hs_log_level_t;
+
+typedef struct {
+    // GPIO
+    void (*led)(hs_led_t status);                   // Indicator pattern, blinking is up to the backend
+
+    // Timer
+    uint32_t (*now_ms)(void);                       // Monotonic
+    uint32_t (*time_s)(void);                       // Wall clock, UTC seconds
+    void (*sleep_ms)(uint32_t ms);
+    void (*wait_event)(uint32_t ms);                // Until a button / link event or timeout
+    void (*power)(hs_power_state_t state);          // Apply CPU and radio settings
+    void (*reset)(void);
+
+    // Audio in, 16 kHz mono PCM (optional)
+    int (*audio_start)(void);
+    size_t (*audio_read)(uint8_t *buf, size_t len); // Non-blocking, bytes captured so far
+    void (*audio_stop)(void);
+
+    // Audio out (optional)
+    void (*audio_play)(const uint8_t *pcm, size_t len);
+
+    // Network
+    int (*net_connect)(const char *ssid, const char *pass);
+    /**
+     * headers is a NULL terminated list of name, value pairs. On success
+     * *resp_len is set to the body length, which may exceed resp_max.
+     */
+    int (*http_post)(const char *url, const char *content_type, const char *const *headers,
+                     const uint8_t *body, size_t body_len,
+                     uint8_t *resp, size_t resp_max, size_t *resp_len);
+    /**
+     * Streaming GET for downloads (optional). One connection per open, with
+     * "Range: bytes=<offset>-" sent only when offset > 0. None of these
+     * block, the main loop keeps running while the network stalls: open()
+     * only starts the request, NULL if it cannot. head() returns 1 until
+     * the response head is in, then 0 with it filled in. read() sets *got
+     * to the body bytes that have arrived, possibly 0. Both return -1 once
+     * the connection has failed, timed out or closed and nothing buffered
+     * is left; an HTTP/1.0 body ending early looks the same.
+     */
+    void *(*http_get_open)(const char *url, uint32_t offset);
+    int (*http_get_head)(void *stream, hs_http_head_t *head);
+    int (*http_get_read)(void *stream, uint8_t *buf, size_t len, size_t *got);
+    void (*http_get_close)(void *stream);
+
+    // Storage
+    const hs_flash_ops_t *flash;
+    void *flash_ctx;
+    int (*partition)(hs_part_t part, uint32_t *base, uint32_t *size);  // From the platform partition table
+
+    // Firmware install (optional), the package replaces the firmware on the next reset
+    int (*ota_install)(const hs_flash_region_t *pkg, uint32_t size);
+
+    // Diagnostics
+    void (*log)(hs_log_level_t level, const char *line);
+    uint32_t (*free_heap)(void);
+} hs_hal_t;
+
+/**
+ * @brief Install the backend, before any other hs_* call
+ */
+void hs_hal_set(const hs_hal_t *hal);
+
+/**
+ * @brief Current backend
+ */
+const hs_hal_t *hs_hal(void);
+
+/**
+ * @brief printf-style log line through hal->log
+ */
+void hs_log(hs_log_level_t level, const char *fmt, ...);
+
+#define HS_LOGE(...)    hs_log(HS_LOG_ERR, __VA_ARGS__)
+#define HS_LOGI(...)    hs_log(HS_LOG_INFO, __VA_ARGS__)
+#define HS_LOGD(...)    hs_log(HS_LOG_DEBUG, __VA_ARGS__)
+
+#endif // HS_HAL_H
@@ -0,0 +1,548 @@
+/**
+ * @file hs_ledger.c
+ * @brief HeySalad T5 Terminal - Local transaction ledger
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#include "hs_ledger.h"
+
+#include <string.h>
+
+#include "heysalad_config.h"
+
+#define LEDGER_MAGIC        0x4C48      // "HL"
+#define LEDGER_SLOT_SIZE    64
+
+// Slots at the end of each sector that only compaction writes. A sector
+// never holds more live records than the others, so copying it survives
+// this many torn writes from power cuts during compaction and recovery
+#define LEDGER_SPARE_SLOTS  2
+
+// One flash slot
+typedef struct {
+    uint16_t magic;
+    uint8_t  status;
+    uint8_t  synced;
+    uint32_t seq;
+    uint32_t txn;
+    uint32_t ts;
+    int32_t  amount;
+    char     currency[4];
+    char     ref[HS_LEDGER_REF_MAX];
+    uint32_t crc;           // Over all preceding bytes
+} ledger_rec_t;
+
+typedef char ledger_rec_size_check[(sizeof(ledger_rec_t) == LEDGER_SLOT_SIZE) ? 1 : -1];
+
+static const hs_flash_region_t *g_region = NULL;
+static uint32_t g_sectors = 0;
+static uint32_t g_per_sector = 0;       // Slots per sector
+
+// Append position; sector g_head + 1 is always erased
+static uint32_t g_head = 0;
+static uint32_t g_head_slot = 0;
+static uint32_t g_seq = 0;
+static uint32_t g_next_txn = 1;
+
+// Index sorted by txn, oldest first
+static hs_ledger_entry_t g_idx[LEDGER_MAX_TXNS];
+static uint32_t g_count = 0;
+static uint32_t g_cap = 0;
+
+// Aggregates per status, kept in step with the index
+static uint32_t g_status_count[HS_LEDGER_STATUS_MAX];
+static int64_t  g_status_sum[HS_LEDGER_STATUS_MAX];
+static uint32_t g_last_txn[HS_LEDGER_STATUS_MAX];   // 0 = none
+
+// ============================================
+// Flash slots
+// ============================================
+
+static uint32_t slot_addr(uint32_t slot)
+{
+    return (slot / g_per_sector) * g_region->sector_size + (slot % g_per_sector) * LEDGER_SLOT_SIZE;
+}
+
+static int rec_read(uint32_t slot, ledger_rec_t *rec)
+{
+    return hs_flash_read(g_region, slot_addr(slot), rec, sizeof(*rec));
+}
+
+static int rec_is_free(const ledger_rec_t *rec)
+{
+    const uint8_t *p = (const uint8_t *)rec;
+    for (size_t i = 0; i < sizeof(*rec); i++) {
+        if (p[i] != 0xFF) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int rec_is_valid(const ledger_rec_t *rec)
+{
+    return rec->magic == LEDGER_MAGIC && rec->status < HS_LEDGER_STATUS_MAX &&
+           rec->crc == hs_crc32(0, rec, offsetof(ledger_rec_t, crc));
+}
+
+static int sector_is_free(uint32_t sector)
+{
+    ledger_rec_t rec;
+    for (uint32_t i = 0; i < g_per_sector; i++) {
+        if (rec_read(sector * g_per_sector + i, &rec) != 0 || !rec_is_free(&rec)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// ============================================
+// Index
+// ============================================
+
+/**
+ * @brief Position of the first entry with txn >= key
+ */
+static uint32_t idx_lower_bound(uint32_t key)
+{
+    uint32_t lo = 0, hi = g_count;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (g_idx[mid].txn < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static hs_ledger_entry_t *idx_find(uint32_t txn)
+{
+    uint32_t pos = idx_lower_bound(txn);
+    return (pos < g_count && g_idx[pos].txn == txn) ? &g_idx[pos] : NULL;
+}
+
+static void last_recompute(uint8_t status)
+{
+    g_last_txn[status] = 0;
+    for (uint32_t i = g_count; i > 0; i--) {
+        if (g_idx[i - 1].status == status) {
+            g_last_txn[status] = g_idx[i - 1].txn;
+            return;
+        }
+    }
+}
+
+static void agg_add(const hs_ledger_entry_t *e)
+{
+    g_status_count[e->status]++;
+    g_status_sum[e->status] += e->amount;
+    if (e->txn > g_last_txn[e->status]) {
+        g_last_txn[e->status] = e->txn;
+    }
+}
+
+/**
+ * @brief Remove e from the aggregates; the caller fixes up g_last_txn
+ */
+static int agg_del(const hs_ledger_entry_t *e)
+{
+    g_status_count[e->status]--;
+    g_status_sum[e->status] -= e->amount;
+    return g_last_txn[e->status] == e->txn;
+}
+
+static void idx_remove(uint32_t pos)
+{
+    uint8_t status = g_idx[pos].status;
+    int was_last = agg_del(&g_idx[pos]);
+
+    memmove(&g_idx[pos], &g_idx[pos + 1], (g_count - pos - 1) * sizeof(g_idx[0]));
+    g_count--;
+    if (was_last) {
+        last_recompute(status);
+    }
+}
+
+/**
+ * @brief Insert in txn order, dropping the oldest entry when full
+ */
+static hs_ledger_entry_t *idx_insert(const hs_ledger_entry_t *e)
+{
+    uint32_t pos = 0;
+
+    if (g_count == g_cap) {
+        if (e->txn < g_idx[0].txn) {
+            return NULL;
+        }
+        idx_remove(0);
+    }
+    pos = idx_lower_bound(e->txn);
+    memmove(&g_idx[pos + 1], &g_idx[pos], (g_count - pos) * sizeof(g_idx[0]));
+    g_idx[pos] = *e;
+    g_count++;
+    agg_add(&g_idx[pos]);
+    return &g_idx[pos];
+}
+
+static void entry_set_status(hs_ledger_entry_t *e, uint8_t status)
+{
+    uint8_t old = e->status;
+
+    if (old == status) {
+        return;
+    }
+    int was_last = agg_del(e);
+    e->status = status;
+    agg_add(e);
+    if (was_last) {
+        last_recompute(old);
+    }
+}
+
+static void entry_from_rec(hs_ledger_entry_t *e, const ledger_rec_t *rec, uint32_t slot)
+{
+    const char *nul = memchr(rec->ref, '\0', sizeof(rec->ref));
+
+    memset(e, 0, sizeof(*e));
+    e->txn = rec->txn;
+    e->seq = rec->seq;
+    e->ts = rec->ts;
+    e->amount = rec->amount;
+    e->ref_hash = hs_crc32(0, rec->ref, nul ? (size_t)(nul - rec->ref) : sizeof(rec->ref));
+    e->slot = (uint16_t)slot;
+    e->status = rec->status;
+    e->synced = rec->synced;
+    memcpy(e->currency, rec->currency, sizeof(e->currency));
+    e->currency[sizeof(e->currency) - 1] = '\0';
+}
+
+/**
+ * @brief Fold one valid flash record into the index during the boot scan
+ */
+static void idx_merge(const ledger_rec_t *rec, uint32_t slot)
+{
+    hs_ledger_entry_t *e = idx_find(rec->txn);
+    hs_ledger_entry_t n;
+
+    if (e) {
+        if ((int32_t)(rec->seq - e->seq) > 0) {
+            entry_set_status(e, rec->status);
+            e->synced = rec->synced;
+            e->seq = rec->seq;
+            e->slot = (uint16_t)slot;
+        }
+        return;
+    }
+    entry_from_rec(&n, rec, slot);
+    idx_insert(&n);
+}
+
+// ============================================
+// Log
+// ============================================
+
+static int write_slot(ledger_rec_t *rec, uint32_t *slot)
+{
+    *slot = g_head * g_per_sector + g_head_slot;
+    rec->magic = LEDGER_MAGIC;
+    rec->seq = g_seq + 1;
+    rec->crc = hs_crc32(0, rec, offsetof(ledger_rec_t, crc));
+
+    // A failed write leaves a torn slot, never reuse it
+    g_head_slot++;
+    if (hs_flash_write(g_region, slot_addr(*slot), rec, sizeof(*rec)) != 0) {
+        return -1;
+    }
+    g_seq = rec->seq;
+    return 0;
+}
+
+/**
+ * @brief Copy records still current out of sector, then erase it
+ *
+ * Called with a freshly erased head. Appends stop LEDGER_SPARE_SLOTS short
+ * of the end of a sector, so the head has room for every live record plus
+ * that many torn slots. Only after more power cuts than that during one
+ * compaction can it run out; the affected transactions are then dropped
+ * from history.
+ */
+static int compact(uint32_t sector)
+{
+    for (uint32_t i = 0; i < g_count; i++) {
+        hs_ledger_entry_t *e = &g_idx[i];
+        ledger_rec_t rec;
+        uint32_t slot = 0;
+
+        if (e->slot / g_per_sector != sector) {
+            continue;
+        }
+        if (g_head_slot >= g_per_sector || rec_read(e->slot, &rec) != 0 ||
+            !rec_is_valid(&rec) || write_slot(&rec, &slot) != 0) {
+            idx_remove(i--);
+            continue;
+        }
+        e->slot = (uint16_t)slot;
+        e->seq = rec.seq;
+    }
+    return hs_flash_erase(g_region, sector * g_region->sector_size, g_region->sector_size);
+}
+
+static int append(ledger_rec_t *rec, uint32_t *slot)
+{
+    // Terminates because g_cap leaves at least one sector of dead slots
+    for (uint32_t tries = 0; g_head_slot >= g_per_sector - LEDGER_SPARE_SLOTS; tries++) {
+        if (tries >= g_sectors) {
+            return -1;
+        }
+        g_head = (g_head + 1) % g_sectors;
+        g_head_slot = 0;
+        if (compact((g_head + 1) % g_sectors) != 0) {
+            return -1;
+        }
+    }
+    return write_slot(rec, slot);
+}
+
+/**
+ * @brief First free slot after the last used one in sector
+ */
+static uint32_t sector_tail(uint32_t sector)
+{
+    ledger_rec_t rec;
+    for (uint32_t i = g_per_sector; i > 0; i--) {
+        if (rec_read(sector * g_per_sector + i - 1, &rec) != 0 || !rec_is_free(&rec)) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+// ============================================
+// Public API
+// ============================================
+
+int hs_ledger_init(const hs_flash_region_t *region)
+{
+    uint32_t slots = 0;
+    int found = 0;
+
+    g_region = NULL;
+    g_count = 0;
+    memset(g_status_count, 0, sizeof(g_status_count));
+    memset(g_status_sum, 0, sizeof(g_status_sum));
+    memset(g_last_txn, 0, sizeof(g_last_txn));
+
+    if (!region || region->sector_size < (LEDGER_SPARE_SLOTS + 1) * LEDGER_SLOT_SIZE ||
+        region->size / region->sector_size < 3) {
+        return -1;
+    }
+    g_region = region;
+    g_sectors = region->size / region->sector_size;
+    g_per_sector = region->sector_size / LEDGER_SLOT_SIZE;
+    slots = g_sectors * g_per_sector;
+    if (slots > 0xFFFF) {
+        g_region = NULL;
+        return -1;
+    }
+
+    // Keep a sector of slack so compaction always frees space
+    g_cap = (g_sectors - 2) * (g_per_sector - LEDGER_SPARE_SLOTS);
+    if (g_cap > LEDGER_MAX_TXNS) {
+        g_cap = LEDGER_MAX_TXNS;
+    }
+
+    g_head = 0;
+    g_seq = 0;
+    g_next_txn = 1;
+    for (uint32_t slot = 0; slot < slots; slot++) {
+        ledger_rec_t rec;
+        if (rec_read(slot, &rec) != 0 || rec_is_free(&rec) || !rec_is_valid(&rec)) {
+            continue;
+        }
+        idx_merge(&rec, slot);
+        if (!found || (int32_t)(rec.seq - g_seq) > 0) {
+            found = 1;
+            g_seq = rec.seq;
+            g_head = slot / g_per_sector;
+        }
+        if (rec.txn >= g_next_txn) {
+            g_next_txn = rec.txn + 1;
+        }
+    }
+    g_head_slot = sector_tail(g_head);
+
+    // A power cut during compaction leaves the spare sector dirty
+    if (!sector_is_free((g_head + 1) % g_sectors)) {
+        return compact((g_head + 1) % g_sectors);
+    }
+    return 0;
+}
+
+int hs_ledger_add(uint32_t ts, int32_t amount, const char *currency, const char *ref,
+                  hs_ledger_status_t status, uint32_t *txn)
+{
+    ledger_rec_t rec;
+    hs_ledger_entry_t e;
+    uint32_t slot = 0;
+
+    if (!g_region || status >= HS_LEDGER_STATUS_MAX) {
+        return -1;
+    }
+    memset(&rec, 0, sizeof(rec));
+    rec.status = (uint8_t)status;
+    rec.txn = g_next_txn;
+    rec.ts = ts;
+    rec.amount = amount;
+    strncpy(rec.currency, currency ? currency : "", sizeof(rec.currency) - 1);
+    strncpy(rec.ref, ref ? ref : "", sizeof(rec.ref) - 1);
+
+    if (append(&rec, &slot) != 0) {
+        return -1;
+    }
+    g_next_txn++;
+    entry_from_rec(&e, &rec, slot);
+    idx_insert(&e);
+    if (txn) {
+        *txn = rec.txn;
+    }
+    return 0;
+}
+
+/**
+ * @brief Write a new record of e with another status, rec its current one
+ */
+static int entry_update(hs_ledger_entry_t *e, ledger_rec_t *rec, hs_ledger_status_t status, int synced)
+{
+    uint32_t txn = e->txn;
+    uint32_t slot = 0;
+
+    if (e->status == status && e->synced == (synced ? 1 : 0)) {
+        return 0;
+    }
+
+    rec->status = (uint8_t)status;
+    rec->synced = synced ? 1 : 0;
+    if (append(rec, &slot) != 0) {
+        return -1;
+    }
+    // Compaction may have moved or dropped entries
+    e = idx_find(txn);
+    if (e) {
+        entry_set_status(e, rec->status);
+        e->synced = rec->synced;
+        e->seq = rec->seq;
+        e->slot = (uint16_t)slot;
+    }
+    return 0;
+}
+
+int hs_ledger_update(const char *ref, hs_ledger_status_t status, int synced)
+{
+    uint32_t hash = 0;
+    ledger_rec_t rec;
+
+    if (!g_region || !ref || status >= HS_LEDGER_STATUS_MAX) {
+        return -1;
+    }
+    hash = hs_crc32(0, ref, strlen(ref));
+
+    // Settlements almost always concern recent payments, search newest first
+    for (uint32_t i = g_count; i > 0; i--) {
+        hs_ledger_entry_t *e = &g_idx[i - 1];
+
+        if (e->ref_hash != hash) {
+            continue;
+        }
+        if (rec_read(e->slot, &rec) != 0 || !rec_is_valid(&rec) ||
+            strncmp(rec.ref, ref, sizeof(rec.ref)) != 0) {
+            continue;
+        }
+        return entry_update(e, &rec, status, synced);
+    }
+    return -1;
+}
+
+int hs_ledger_update_txn(uint32_t txn, hs_ledger_status_t status, int synced)
+{
+    hs_ledger_entry_t *e = idx_find(txn);
+    ledger_rec_t rec;
+
+    if (!g_region || !e || status >= HS_LEDGER_STATUS_MAX ||
+        rec_read(e->slot, &rec) != 0 || !rec_is_valid(&rec)) {
+        return -1;
+    }
+    return entry_update(e, &rec, status, synced);
+}
+
+int hs_ledger_last(hs_ledger_status_t status, hs_ledger_entry_t *out)
+{
+    hs_ledger_entry_t *e = NULL;
+
+    if (status >= HS_LEDGER_STATUS_MAX || g_last_txn[status] == 0) {
+        return -1;
+    }
+    e = idx_find(g_last_txn[status]);
+    if (!e) {
+        return -1;
+    }
+    *out = *e;
+    return 0;
+}
+
+void hs_ledger_totals(hs_ledger_status_t status, uint32_t since_ts, uint32_t *count, int64_t *sum)
+{
+    uint32_t c = 0;
+    int64_t s = 0;
+
+    if (status >= HS_LEDGER_STATUS_MAX) {
+        *count = 0;
+        *sum = 0;
+        return;
+    }
+    if (since_ts == 0) {
+        *count = g_status_count[status];
+        *sum = g_status_sum[status];
+        return;
+    }
+    // Index is in creation order, stop at the first older entry
+    for (uint32_t i = g_count; i > 0 && g_idx[i - 1].ts >= since_ts; i--) {
+        if (g_idx[i - 1].status == status) {
+            c++;
+            s += g_idx[i - 1].amount;
+        }
+    }
+    *count = c;
+    *sum = s;
+}
+
+int hs_ledger_next_pending(uint32_t after_txn, hs_ledger_entry_t *out)
+{
+    for (uint32_t i = idx_lower_bound(after_txn + 1); i < g_count; i++) {
+        if (g_idx[i].status == HS_LEDGER_PENDING && !g_idx[i].synced) {
+            *out = g_idx[i];
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int hs_ledger_ref(const hs_ledger_entry_t *entry, char *ref, size_t len)
+{
+    ledger_rec_t rec;
+
+    if (!g_region || len == 0 || rec_read(entry->slot, &rec) != 0 || !rec_is_valid(&rec)) {
+        return -1;
+    }
+    rec.ref[sizeof(rec.ref) - 1] = '\0';
+    strncpy(ref, rec.ref, len - 1);
+    ref[len - 1] = '\0';
+    return 0;
+}
+
+uint32_t hs_ledger_count(void)
+{
+    return g_count;
+}
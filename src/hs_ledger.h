@@ -0,0 +1,115 @@
+/**
+ * @file hs_ledger.h
+ * @brief HeySalad T5 Terminal - Local transaction ledger
+ *
+ * Append-only log of payment records in a ring of flash sectors, with a
+ * RAM index so "last payment" and takings queries never touch the network.
+ *
+ * Every record is a complete 64 byte snapshot of one transaction; the
+ * record with the highest sequence number wins. One sector is always kept
+ * erased: when the head sector fills, the next sector becomes head and the
+ * one after it is compacted (records still current are copied to the head,
+ * then it is erased). Flash use is fixed at LEDGER_SECTORS sectors, and the
+ * index keeps the newest LEDGER_MAX_TXNS transactions.
+ *
+ * A power cut at any point leaves either the old or the new record of a
+ * transaction; torn slots fail their CRC and are skipped on the next scan.
+ * A compaction cut short is finished at the next hs_ledger_init(). The last
+ * two slots of each sector are left to compaction, so the copies still fit
+ * when cuts during compaction and its recovery leave torn slots behind.
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#ifndef HS_LEDGER_H
+#define HS_LEDGER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hs_flash.h"
+
+#define HS_LEDGER_REF_MAX   36          // Server payment id, NUL included
+
+typedef enum {
+    HS_LEDGER_PENDING = 0,              // Created, customer has not paid
+    HS_LEDGER_PAID,
+    HS_LEDGER_FAILED,
+    HS_LEDGER_EXPIRED,
+    HS_LEDGER_STATUS_MAX
+} hs_ledger_status_t;
+
+/**
+ * @brief Index entry, everything a query needs without reading flash
+ */
+typedef struct {
+    uint32_t txn;           // Local id, increases with creation time
+    uint32_t seq;           // Sequence of the current record
+    uint32_t ts;            // Creation time, seconds
+    int32_t  amount;        // Minor units (ngwee, cents)
+    uint32_t ref_hash;
+    uint16_t slot;          // Flash slot of the current record
+    uint8_t  status;
+    uint8_t  synced;        // Status confirmed by the server
+    char     currency[4];
+} hs_ledger_entry_t;
+
+/**
+ * @brief Scan region and rebuild the index
+ *
+ * region must hold at least 3 sectors.
+ */
+int hs_ledger_init(const hs_flash_region_t *region);
+
+/**
+ * @brief Record a new transaction
+ */
+int hs_ledger_add(uint32_t ts, int32_t amount, const char *currency, const char *ref,
+                  hs_ledger_status_t status, uint32_t *txn);
+
+/**
+ * @brief Apply a status change for the transaction with server id ref
+ *
+ * @param synced Non-zero when the status comes from the server
+ */
+int hs_ledger_update(const char *ref, hs_ledger_status_t status, int synced);
+
+/**
+ * @brief Apply a status change for the transaction with local id txn
+ *
+ * For entries the server cannot be asked about, such as a payment that
+ * outlived PAYMENT_TIMEOUT_SEC without an answer.
+ */
+int hs_ledger_update_txn(uint32_t txn, hs_ledger_status_t status, int synced);
+
+/**
+ * @brief Newest transaction with the given status, O(1)
+ */
+int hs_ledger_last(hs_ledger_status_t status, hs_ledger_entry_t *out);
+
+/**
+ * @brief Count and sum of transactions with status created at or after since_ts
+ *
+ * since_ts == 0 is O(1), otherwise only the matching tail of the index is
+ * walked. Sums mix currencies; terminals run in one currency.
+ */
+void hs_ledger_totals(hs_ledger_status_t status, uint32_t since_ts, uint32_t *count, int64_t *sum);
+
+/**
+ * @brief Oldest unsynced pending transaction with txn > after_txn
+ *
+ * Lets a background task walk pending entries for reconciliation.
+ */
+int hs_ledger_next_pending(uint32_t after_txn, hs_ledger_entry_t *out);
+
+/**
+ * @brief Read the server payment id of an entry from flash
+ */
+int hs_ledger_ref(const hs_ledger_entry_t *entry, char *ref, size_t len);
+
+/**
+ * @brief Number of transactions in the index
+ */
+uint32_t hs_ledger_count(void);
+
+#endif // HS_LEDGER_H
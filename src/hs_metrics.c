@@ -0,0 +1,192 @@
+/**
+ * @file hs_metrics.c
+ * @brief HeySalad T5 Terminal - Field telemetry registry
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#include "hs_metrics.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#define LOAD(p)         __atomic_load_n((p), __ATOMIC_RELAXED)
+#define ADD(p, n)       __atomic_fetch_add((p), (n), __ATOMIC_RELAXED)
+
+typedef struct {
+    uint32_t counter[HS_METRIC_COUNTER_MAX];
+    int32_t  gauge[HS_METRIC_GAUGE_MAX];
+    uint32_t count[HS_METRIC_HIST_MAX];
+    uint32_t sum[HS_METRIC_HIST_MAX];
+    uint32_t bucket[HS_METRIC_HIST_MAX][HS_METRICS_BUCKETS];
+} metrics_snap_t;
+
+static const uint32_t g_bounds[HS_METRICS_BUCKETS - 1] = {
+    50, 100, 250, 500, 1000, 2500, 5000
+};
+
+// Only ever increased; deltas are taken modulo 2^32
+static metrics_snap_t g_live;
+
+static metrics_snap_t g_sent;           // As of the last delivered batch
+static metrics_snap_t g_pending;        // As of the last encoded batch
+static uint32_t g_sent_ms = 0;
+static uint32_t g_pending_ms = 0;
+static uint32_t g_seq = 0;
+
+void hs_metrics_init(uint32_t now_ms)
+{
+    memset(&g_live, 0, sizeof(g_live));
+    memset(&g_sent, 0, sizeof(g_sent));
+    memset(&g_pending, 0, sizeof(g_pending));
+    g_sent_ms = now_ms;
+    g_pending_ms = now_ms;
+    g_seq = 0;
+}
+
+void hs_metrics_add(hs_metric_counter_t id, uint32_t n)
+{
+    if (id < HS_METRIC_COUNTER_MAX) {
+        ADD(&g_live.counter[id], n);
+    }
+}
+
+void hs_metrics_inc(hs_metric_counter_t id)
+{
+    hs_metrics_add(id, 1);
+}
+
+void hs_metrics_set(hs_metric_gauge_t id, int32_t value)
+{
+    if (id < HS_METRIC_GAUGE_MAX) {
+        __atomic_store_n(&g_live.gauge[id], value, __ATOMIC_RELAXED);
+    }
+}
+
+void hs_metrics_observe(hs_metric_hist_t id, uint32_t ms)
+{
+    int b = 0;
+
+    if (id >= HS_METRIC_HIST_MAX) {
+        return;
+    }
+    while (b < HS_METRICS_BUCKETS - 1 && ms > g_bounds[b]) {
+        b++;
+    }
+    ADD(&g_live.bucket[id][b], 1);
+    ADD(&g_live.sum[id], ms);
+    ADD(&g_live.count[id], 1);
+}
+
+static void snapshot(metrics_snap_t *s)
+{
+    int i, b;
+
+    for (i = 0; i < HS_METRIC_COUNTER_MAX; i++) {
+        s->counter[i] = LOAD(&g_live.counter[i]);
+    }
+    for (i = 0; i < HS_METRIC_GAUGE_MAX; i++) {
+        s->gauge[i] = LOAD(&g_live.gauge[i]);
+    }
+    for (i = 0; i < HS_METRIC_HIST_MAX; i++) {
+        s->count[i] = LOAD(&g_live.count[i]);
+        s->sum[i] = LOAD(&g_live.sum[i]);
+        for (b = 0; b < HS_METRICS_BUCKETS; b++) {
+            s->bucket[i][b] = LOAD(&g_live.bucket[i][b]);
+        }
+    }
+}
+
+static int put(char *buf, size_t len, size_t *pos, const char *fmt, ...)
+{
+    va_list ap;
+    int n;
+
+    va_start(ap, fmt);
+    n = vsnprintf(buf + *pos, len - *pos, fmt, ap);
+    va_end(ap);
+    if (n < 0 || (size_t)n >= len - *pos) {
+        return -1;
+    }
+    *pos += n;
+    return 0;
+}
+
+int hs_metrics_batch(uint32_t now_ms, char *buf, size_t len)
+{
+    const metrics_snap_t *s = &g_pending;
+    size_t pos = 0;
+    int changed = 0;
+    int i, b;
+
+    if (!buf || len == 0) {
+        return -1;
+    }
+    snapshot(&g_pending);
+    g_pending_ms = now_ms;
+
+    if (put(buf, len, &pos, "1|%u|%u", (unsigned)g_seq, (unsigned)((now_ms - g_sent_ms) / 1000)) != 0) {
+        return -1;
+    }
+
+    const char *sep = "|c:";
+    for (i = 0; i < HS_METRIC_COUNTER_MAX; i++) {
+        uint32_t d = s->counter[i] - g_sent.counter[i];
+        if (d == 0) {
+            continue;
+        }
+        if (put(buf, len, &pos, "%s%d=%u", sep, i, (unsigned)d) != 0) {
+            return -1;
+        }
+        sep = ",";
+        changed = 1;
+    }
+
+    // Gauges are reported as they are, there is nothing to subtract
+    sep = "|g:";
+    for (i = 0; i < HS_METRIC_GAUGE_MAX; i++) {
+        if (s->gauge[i] != g_sent.gauge[i]) {
+            changed = 1;
+        }
+        if (put(buf, len, &pos, "%s%d=%d", sep, i, (int)s->gauge[i]) != 0) {
+            return -1;
+        }
+        sep = ",";
+    }
+
+    sep = "|h:";
+    for (i = 0; i < HS_METRIC_HIST_MAX; i++) {
+        uint32_t n = s->count[i] - g_sent.count[i];
+        int last = 0;
+        if (n == 0) {
+            continue;
+        }
+        if (put(buf, len, &pos, "%s%d=%u/%u/", sep, i, (unsigned)n,
+                (unsigned)(s->sum[i] - g_sent.sum[i])) != 0) {
+            return -1;
+        }
+        for (b = 0; b < HS_METRICS_BUCKETS; b++) {
+            if (s->bucket[i][b] != g_sent.bucket[i][b]) {
+                last = b;
+            }
+        }
+        for (b = 0; b <= last; b++) {
+            if (put(buf, len, &pos, b ? ".%u" : "%u",
+                    (unsigned)(s->bucket[i][b] - g_sent.bucket[i][b])) != 0) {
+                return -1;
+            }
+        }
+        sep = ",";
+        changed = 1;
+    }
+
+    return changed ? (int)pos : 0;
+}
+
+void hs_metrics_ack(void)
+{
+    memcpy(&g_sent, &g_pending, sizeof(g_sent));
+    g_sent_ms = g_pending_ms;
+    g_seq++;
+}
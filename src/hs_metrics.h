@@ -0,0 +1,97 @@
+/**
+ * @file hs_metrics.h
+ * @brief HeySalad T5 Terminal - Field telemetry registry
+ *
+ * Fixed set of counters, gauges and latency histograms. Updates are single
+ * relaxed atomic operations, so any task or interrupt handler may record
+ * without taking a lock.
+ *
+ * Uploads carry only what changed since the last delivered batch, encoded
+ * as one short ASCII line that fits in an HTTP header:
+ *
+ *   1|<seq>|<period_s>|c:<id>=<n>,...|g:<id>=<v>,...|h:<id>=<count>/<sum_ms>/<b0>.<b1>...
+ *
+ * Sections with nothing to report are left out and trailing empty buckets
+ * are trimmed. A batch that is never acknowledged is folded into the next
+ * one, so a failed upload loses nothing. The collector keeps the newest
+ * batch per seq, so a batch resent after a lost reply is not counted twice.
+ *
+ * The line is not compressed. Typical batches are 40-110 bytes with little
+ * repetition; deflate saves a few bytes at best, and the base64 a header
+ * needs for binary makes the result larger (44 -> 56, 108 -> 104 bytes).
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#ifndef HS_METRICS_H
+#define HS_METRICS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Ids are part of the upload format, only ever append
+typedef enum {
+    HS_METRIC_HTTP_ERRORS = 0,
+    HS_METRIC_VOICE_ERRORS,
+    HS_METRIC_PAYMENT_ERRORS,
+    HS_METRIC_WIFI_RECONNECTS,
+    HS_METRIC_AUDIO_OVERRUNS,
+    HS_METRIC_COUNTER_MAX
+} hs_metric_counter_t;
+
+typedef enum {
+    HS_METRIC_HEAP_FREE = 0,
+    HS_METRIC_LEDGER_TXNS,
+    HS_METRIC_GAUGE_MAX
+} hs_metric_gauge_t;
+
+typedef enum {
+    HS_METRIC_HTTP_POST_MS = 0,
+    HS_METRIC_VOICE_MS,
+    HS_METRIC_PAYMENT_MS,
+    HS_METRIC_HIST_MAX
+} hs_metric_hist_t;
+
+// Upper bounds in ms: 50, 100, 250, 500, 1000, 2500, 5000, above
+#define HS_METRICS_BUCKETS  8
+
+/**
+ * @brief Reset the registry, now_ms starts the first reporting period
+ */
+void hs_metrics_init(uint32_t now_ms);
+
+/**
+ * @brief Add n to a counter
+ */
+void hs_metrics_add(hs_metric_counter_t id, uint32_t n);
+
+/**
+ * @brief Add one to a counter
+ */
+void hs_metrics_inc(hs_metric_counter_t id);
+
+/**
+ * @brief Set a gauge, the last value before a batch is reported
+ */
+void hs_metrics_set(hs_metric_gauge_t id, int32_t value);
+
+/**
+ * @brief Record one latency sample
+ */
+void hs_metrics_observe(hs_metric_hist_t id, uint32_t ms);
+
+/**
+ * @brief Encode everything recorded since the last acknowledged batch
+ *
+ * Batch and ack must be called from a single task.
+ *
+ * @return Length written (NUL excluded), 0 if nothing new, -1 if buf is too small
+ */
+int hs_metrics_batch(uint32_t now_ms, char *buf, size_t len);
+
+/**
+ * @brief The last batch was delivered, start the next one after it
+ */
+void hs_metrics_ack(void);
+
+#endif // HS_METRICS_H
@@ -0,0 +1,615 @@
+/**
+ * @file hs_ota.c
+ * @brief HeySalad T5 Terminal - Delta OTA update
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#include <string.h>
+
+#include "heysalad_config.h"
+#include "hs_hal.h"
+#include "hs_flash.h"
+#include "hs_delta.h"
+#include "hs_ota.h"
+
+#define OTA_REC_MAGIC       0x41544F48  // "HOTA"
+#define OTA_BOOTCTL_OFFSET  0           // Sectors 0-1 of the meta area
+#define OTA_CKPT_OFFSET     (2 * FLASH_SECTOR_SIZE)  // Sectors 2-3
+
+#define OTA_FETCH_CHUNK     1024
+#define OTA_POLL_BYTES      (8 * OTA_FETCH_CHUNK)    // Per main loop pass
+#define OTA_FETCH_RETRIES   8
+#define OTA_RETRY_BASE_MS   500
+#define OTA_STALL_MS        30000       // No head or body bytes, reconnect
+
+// Header shared by every double buffered record
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t len;
+} ota_rec_hdr_t;
+
+#define OTA_SLOTS           2
+#define OTA_SLOT_NONE       0xFF        // Flashed over USB, no package kept
+
+typedef enum {
+    BOOT_IDLE = 0,
+    BOOT_INSTALLING,            // Handed to the bootloader, not booted yet
+    BOOT_TRIAL,                 // Installed, not confirmed yet
+} ota_boot_state_t;
+
+typedef struct {
+    uint8_t  state;
+    uint8_t  attempts;          // Unconfirmed boots so far
+    uint8_t  slot;              // Package the running firmware came from
+    uint8_t  prev;              // Package of the firmware before it
+    uint8_t  target;            // Package handed to the bootloader
+    uint8_t  rollback;          // target is prev, going back
+    uint16_t reserved;
+    uint32_t app_crc;           // Application partition before the hand over
+    uint32_t size[OTA_SLOTS];   // Package in each slot
+    uint32_t crc[OTA_SLOTS];
+} ota_bootctl_t;
+
+typedef struct {
+    uint32_t url_crc;           // Identifies the patch being downloaded,
+    uint32_t old_crc;           // together with its header
+    uint32_t new_crc;
+    hs_delta_state_t state;
+} ota_ckpt_t;
+
+typedef enum {
+    OTA_IDLE = 0,
+    OTA_RUN,
+    OTA_BACKOFF,                // Waiting out a retry delay
+} ota_phase_t;
+
+// Regions from the partition table, set by hs_ota_init()
+static const hs_flash_region_t *g_app = NULL;
+static const hs_flash_region_t *g_meta = NULL;
+static hs_flash_region_t g_pkg[OTA_SLOTS];
+static hs_flash_region_t g_base;        // Package the running firmware came from
+static int g_staging = 0;               // Slot the next package goes to
+
+static ota_bootctl_t g_bootctl;
+static uint32_t g_bootctl_seq = 0;
+static uint32_t g_ckpt_seq = 0;
+
+// Download in progress
+static ota_phase_t g_phase = OTA_IDLE;
+static char g_url[256];
+static void *g_stream = NULL;
+static int g_have_head = 0;
+static int g_starved = 0;       // Last poll found no bytes waiting
+static int g_retries = 0;
+static uint32_t g_retry_at = 0;
+static uint32_t g_stall_at = 0;
+static int g_probing = 0;       // Re-reading the header before a resume
+static uint8_t g_probe[HS_DELTA_HEADER_SIZE];
+static size_t g_probe_len = 0;
+
+// Kept off the task stacks, ~3 KB together
+static hs_delta_t g_delta;
+static ota_ckpt_t g_ckpt;
+
+// ============================================
+// Double buffered records
+// ============================================
+
+/**
+ * @brief Load the newest valid copy of a record from a pair of sectors
+ */
+static int rec_load(uint32_t offset, void *payload, uint32_t len, uint32_t *seq)
+{
+    int best = -1;
+    uint32_t best_seq = 0;
+
+    for (int i = 0; i < 2; i++) {
+        ota_rec_hdr_t hdr;
+        uint32_t addr = offset + i * FLASH_SECTOR_SIZE;
+        uint32_t crc = 0, stored = 0;
+
+        if (hs_flash_read(g_meta, addr, &hdr, sizeof(hdr)) != 0 ||
+            hdr.magic != OTA_REC_MAGIC || hdr.len != len) {
+            continue;
+        }
+        if (hs_flash_crc32(g_meta, addr, sizeof(hdr) + len, &crc) != 0 ||
+            hs_flash_read(g_meta, addr + sizeof(hdr) + len, &stored, sizeof(stored)) != 0 ||
+            crc != stored) {
+            continue;
+        }
+        if (best < 0 || (int32_t)(hdr.seq - best_seq) > 0) {
+            best = i;
+            best_seq = hdr.seq;
+        }
+    }
+    if (best < 0) {
+        return -1;
+    }
+    *seq = best_seq;
+    return hs_flash_read(g_meta, offset + best * FLASH_SECTOR_SIZE + sizeof(ota_rec_hdr_t), payload, len);
+}
+
+/**
+ * @brief Write a record into the sector not holding the current copy
+ *
+ * The previous copy stays valid until the new one is fully written, so a
+ * power cut leaves one of the two intact.
+ */
+static int rec_save(uint32_t offset, const void *payload, uint32_t len, uint32_t *seq)
+{
+    ota_rec_hdr_t hdr = { OTA_REC_MAGIC, *seq + 1, len };
+    uint32_t addr = offset + (hdr.seq & 1) * FLASH_SECTOR_SIZE;
+    uint32_t crc = 0;
+
+    crc = hs_crc32(crc, &hdr, sizeof(hdr));
+    crc = hs_crc32(crc, payload, len);
+
+    if (hs_flash_erase(g_meta, addr, FLASH_SECTOR_SIZE) != 0 ||
+        hs_flash_write(g_meta, addr, &hdr, sizeof(hdr)) != 0 ||
+        hs_flash_write(g_meta, addr + sizeof(hdr), payload, len) != 0 ||
+        hs_flash_write(g_meta, addr + sizeof(hdr) + len, &crc, sizeof(crc)) != 0) {
+        return -1;
+    }
+    *seq = hdr.seq;
+    return 0;
+}
+
+static int bootctl_save(void)
+{
+    return rec_save(OTA_BOOTCTL_OFFSET, &g_bootctl, sizeof(g_bootctl), &g_bootctl_seq);
+}
+
+/**
+ * @brief Point the delta base at the running firmware's package and
+ *        staging at the other slot
+ */
+static void slots_select(void)
+{
+    uint8_t slot = g_bootctl.slot;
+
+    g_base = g_pkg[slot == OTA_SLOT_NONE ? 0 : slot];
+    if (slot == OTA_SLOT_NONE) {
+        // Nothing to patch against, only full images (old_size 0) apply
+        g_base.size = 0;
+    }
+    g_staging = slot == 0 ? 1 : 0;
+}
+
+/**
+ * @brief Hand the package in slot to the bootloader
+ *
+ * The application partition is fingerprinted first: whether it changed
+ * at the next boot tells whether the bootloader took the package, however
+ * it stores the installed image.
+ */
+static int hand_over(uint8_t slot, int rollback)
+{
+    uint8_t state = g_bootctl.state;
+
+    if (hs_flash_crc32(g_app, 0, g_app->size, &g_bootctl.app_crc) != 0) {
+        return -1;
+    }
+    g_bootctl.state = BOOT_INSTALLING;
+    g_bootctl.target = slot;
+    g_bootctl.rollback = (uint8_t)rollback;
+    if (bootctl_save() != 0 || hs_hal()->ota_install(&g_pkg[slot], g_bootctl.size[slot]) != 0) {
+        g_bootctl.state = state;
+        bootctl_save();
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief First boot after a hand over: find out whether it was installed
+ */
+static int boot_installed(void)
+{
+    uint8_t target = g_bootctl.target;
+    uint32_t crc = 0;
+
+    if (hs_flash_crc32(g_app, 0, g_app->size, &crc) != 0) {
+        return -1;
+    }
+    if (crc == g_bootctl.app_crc) {
+        HS_LOGE("OTA: package %08x was not installed", (unsigned)g_bootctl.crc[target]);
+        g_bootctl.state = g_bootctl.rollback ? BOOT_TRIAL : BOOT_IDLE;
+        return bootctl_save();
+    }
+    if (g_bootctl.rollback) {
+        // Back on a confirmed image; the other slot holds the failed one
+        HS_LOGI("OTA: rolled back to package %08x", (unsigned)g_bootctl.crc[target]);
+        g_bootctl.state = BOOT_IDLE;
+        g_bootctl.prev = OTA_SLOT_NONE;
+    } else {
+        g_bootctl.state = BOOT_TRIAL;
+        g_bootctl.prev = g_bootctl.slot;
+    }
+    g_bootctl.slot = target;
+    g_bootctl.attempts = 0;
+    slots_select();
+    return bootctl_save();
+}
+
+static void ckpt_clear(void)
+{
+    hs_flash_erase(g_meta, OTA_CKPT_OFFSET, 2 * FLASH_SECTOR_SIZE);
+    g_ckpt_seq = 0;
+}
+
+/**
+ * @brief hs_delta checkpoint callback, runs once per completed sector
+ */
+static int ckpt_save(void *arg, const hs_delta_state_t *state)
+{
+    (void)arg;
+    g_ckpt.old_crc = state->hdr.old_crc;
+    g_ckpt.new_crc = state->hdr.new_crc;
+    memcpy(&g_ckpt.state, state, sizeof(g_ckpt.state));
+    return rec_save(OTA_CKPT_OFFSET, &g_ckpt, sizeof(g_ckpt), &g_ckpt_seq);
+}
+
+// ============================================
+// Download
+// ============================================
+
+static void stream_close(void)
+{
+    if (g_stream) {
+        hs_hal()->http_get_close(g_stream);
+        g_stream = NULL;
+    }
+}
+
+/**
+ * @brief Forget any checkpoint and decode from the first patch byte
+ */
+static void fresh_start(void)
+{
+    ckpt_clear();
+    memset(&g_ckpt, 0, sizeof(g_ckpt));
+    g_ckpt.url_crc = hs_crc32(0, g_url, strlen(g_url));
+    hs_delta_init(&g_delta, &g_base, &g_pkg[g_staging], ckpt_save, NULL);
+    g_probing = 0;
+}
+
+/**
+ * @brief Drop the connection and try again after a backoff delay
+ *
+ * Past OTA_FETCH_RETRIES the download stops, but the checkpoint stays for
+ * the next hs_ota_start() to pick up.
+ */
+static int retry_later(const char *why)
+{
+    stream_close();
+    if (++g_retries > OTA_FETCH_RETRIES) {
+        HS_LOGE("OTA: download stalled at %u: %s", (unsigned)hs_delta_offset(&g_delta), why);
+        g_phase = OTA_IDLE;
+        return HS_OTA_FAILED;
+    }
+    HS_LOGD("OTA: %s, retry %d", why, g_retries);
+    g_retry_at = hs_hal()->now_ms() + (OTA_RETRY_BASE_MS << (g_retries < 5 ? g_retries : 5));
+    g_phase = OTA_BACKOFF;
+    return HS_OTA_BUSY;
+}
+
+/**
+ * @brief Nothing arrived this pass: wait for the network, up to OTA_STALL_MS
+ */
+static int stalled(void)
+{
+    if ((int32_t)(hs_hal()->now_ms() - g_stall_at) >= 0) {
+        return retry_later("no data");
+    }
+    g_starved = 1;
+    return HS_OTA_BUSY;
+}
+
+static int fail(int rt)
+{
+    stream_close();
+    ckpt_clear();
+    g_phase = OTA_IDLE;
+    HS_LOGE("OTA: apply failed: %d", rt);
+    return HS_OTA_FAILED;
+}
+
+/**
+ * @brief Request the patch from the current offset, the head arrives later
+ *
+ * @return 0 with g_stream open, otherwise the hs_ota_poll() result
+ */
+static int stream_open(void)
+{
+    uint32_t offset = g_probing ? 0 : hs_delta_offset(&g_delta);
+
+    g_probe_len = 0;
+    g_have_head = 0;
+    g_stream = hs_hal()->http_get_open(g_url, offset);
+    if (!g_stream) {
+        return retry_later("connect failed");
+    }
+    g_stall_at = hs_hal()->now_ms() + OTA_STALL_MS;
+    return 0;
+}
+
+/**
+ * @brief Check the response head against the offset asked for
+ *
+ * @return 0 to read the body, otherwise the hs_ota_poll() result
+ */
+static int head_check(const hs_http_head_t *head)
+{
+    uint32_t offset = g_probing ? 0 : hs_delta_offset(&g_delta);
+
+    g_have_head = 1;
+    if (offset == 0 && head->status == 200) {
+        return 0;
+    }
+    if (head->status == 206 && head->has_range && head->range_start == offset) {
+        return 0;
+    }
+    if (head->status == 200) {
+        // Range ignored, the body starts at byte 0
+        HS_LOGI("OTA: server sent the whole patch, restarting");
+        fresh_start();
+        return 0;
+    }
+    if (head->status == 416) {
+        // Patch is now shorter than our checkpoint, so it is another patch
+        fresh_start();
+    }
+    HS_LOGE("OTA: HTTP %d for offset %u", head->status, (unsigned)offset);
+    return retry_later("bad response");
+}
+
+/**
+ * @brief Whether the patch on the server is still the checkpointed one
+ */
+static int probe_matches(void)
+{
+    hs_delta_header_t hdr;
+
+    hs_delta_read_header(g_probe, &hdr);
+    return hdr.magic == HS_DELTA_MAGIC && hdr.old_crc == g_ckpt.old_crc &&
+           hdr.new_crc == g_ckpt.new_crc && hdr.new_size == g_ckpt.state.hdr.new_size;
+}
+
+/**
+ * @brief Record the verified image and hand it to the bootloader
+ */
+static int install(void)
+{
+    const hs_delta_header_t *hdr = hs_delta_header(&g_delta);
+
+    stream_close();
+    ckpt_clear();
+    g_phase = OTA_IDLE;
+    HS_LOGI("OTA: image verified, %u bytes crc %08x", (unsigned)hdr->new_size, (unsigned)hdr->new_crc);
+
+    g_bootctl.size[g_staging] = hdr->new_size;
+    g_bootctl.crc[g_staging] = hdr->new_crc;
+    if (hand_over((uint8_t)g_staging, 0) != 0) {
+        HS_LOGE("OTA: install refused");
+        return HS_OTA_FAILED;
+    }
+    return HS_OTA_STAGED;
+}
+
+// ============================================
+// Public API
+// ============================================
+
+int hs_ota_init(const hs_flash_region_t *app, const hs_flash_region_t *pkgs,
+                const hs_flash_region_t *meta)
+{
+    const hs_hal_t *hal = hs_hal();
+    uint32_t half = pkgs->size / OTA_SLOTS;
+    uint8_t slot = 0;
+
+    g_app = app;
+    g_meta = meta;
+    g_phase = OTA_IDLE;
+    g_stream = NULL;
+    for (int i = 0; i < OTA_SLOTS; i++) {
+        g_pkg[i] = *pkgs;
+        g_pkg[i].base += i * (half - half % pkgs->sector_size);
+        g_pkg[i].size = half - half % pkgs->sector_size;
+    }
+
+    if (rec_load(OTA_BOOTCTL_OFFSET, &g_bootctl, sizeof(g_bootctl), &g_bootctl_seq) != 0) {
+        // Flashed over USB, never updated
+        memset(&g_bootctl, 0, sizeof(g_bootctl));
+        g_bootctl.slot = OTA_SLOT_NONE;
+        g_bootctl.prev = OTA_SLOT_NONE;
+        g_bootctl_seq = 0;
+    }
+    slots_select();
+
+    if (g_bootctl.state == BOOT_INSTALLING && boot_installed() != 0) {
+        return -1;
+    }
+    if (g_bootctl.state != BOOT_TRIAL) {
+        return 0;
+    }
+
+    slot = g_bootctl.slot;
+    g_bootctl.attempts++;
+    if (g_bootctl.attempts <= OTA_MAX_BOOT_ATTEMPTS) {
+        HS_LOGI("OTA: running package %08x, boot %u of %u", (unsigned)g_bootctl.crc[slot],
+                (unsigned)g_bootctl.attempts, (unsigned)OTA_MAX_BOOT_ATTEMPTS);
+        return bootctl_save();
+    }
+
+    g_bootctl.attempts = 0;
+    if (g_bootctl.prev == OTA_SLOT_NONE) {
+        // Updated from a USB flashed image, which left no package behind
+        HS_LOGE("OTA: package %08x never confirmed, no previous package kept", (unsigned)g_bootctl.crc[slot]);
+        g_bootctl.state = BOOT_IDLE;
+        return bootctl_save();
+    }
+    HS_LOGE("OTA: package %08x never confirmed, rolling back", (unsigned)g_bootctl.crc[slot]);
+    if (hand_over(g_bootctl.prev, 1) != 0) {
+        return -1;
+    }
+    hal->reset();
+    return -1;
+}
+
+void hs_ota_mark_boot_ok(void)
+{
+    if (g_bootctl.state != BOOT_TRIAL) {
+        return;
+    }
+    g_bootctl.state = BOOT_IDLE;
+    g_bootctl.attempts = 0;
+    if (bootctl_save() == 0) {
+        HS_LOGI("OTA: package %08x confirmed", (unsigned)g_bootctl.crc[g_bootctl.slot]);
+    }
+}
+
+int hs_ota_start(const char *url)
+{
+    const hs_hal_t *hal = hs_hal();
+    size_t len = strlen(url);
+    uint32_t crc = 0;
+
+    if (g_phase != OTA_IDLE) {
+        return 0;
+    }
+    if (!g_meta || g_pkg[0].size == 0 || !hal->http_get_open || !hal->http_get_head || !hal->ota_install) {
+        HS_LOGE("OTA: not supported on this platform");
+        return -1;
+    }
+    if (g_bootctl.state != BOOT_IDLE) {
+        // Never replace an image that has not proven itself yet
+        HS_LOGE("OTA: running image not confirmed yet");
+        return -1;
+    }
+    if (len >= sizeof(g_url)) {
+        return -1;
+    }
+    memcpy(g_url, url, len + 1);
+    g_retries = 0;
+    g_probe_len = 0;
+    g_starved = 0;
+    g_phase = OTA_RUN;
+
+    hs_delta_init(&g_delta, &g_base, &g_pkg[g_staging], ckpt_save, NULL);
+    if (rec_load(OTA_CKPT_OFFSET, &g_ckpt, sizeof(g_ckpt), &g_ckpt_seq) == 0 &&
+        g_ckpt.url_crc == hs_crc32(0, url, len) &&
+        hs_flash_crc32(&g_base, 0, g_ckpt.state.hdr.old_size, &crc) == 0 && crc == g_ckpt.old_crc &&
+        hs_delta_resume(&g_delta, &g_ckpt.state) == HS_DELTA_OK) {
+        // Same url, same base; the header read back decides the rest
+        g_probing = 1;
+        return 0;
+    }
+    fresh_start();
+    return 0;
+}
+
+int hs_ota_poll(void)
+{
+    static uint8_t buf[OTA_FETCH_CHUNK];
+    const hs_hal_t *hal = hs_hal();
+    size_t budget = OTA_POLL_BYTES;
+    int rt = 0;
+
+    if (g_phase == OTA_IDLE) {
+        return HS_OTA_IDLE;
+    }
+    if (g_phase == OTA_BACKOFF) {
+        if ((int32_t)(hal->now_ms() - g_retry_at) < 0) {
+            return HS_OTA_BUSY;
+        }
+        g_phase = OTA_RUN;
+    }
+    if (!g_stream && (rt = stream_open()) != 0) {
+        return rt;
+    }
+    g_starved = 0;
+    if (!g_have_head) {
+        hs_http_head_t head = { 0, 0, 0 };
+
+        rt = hal->http_get_head(g_stream, &head);
+        if (rt < 0) {
+            return retry_later("connect failed");
+        }
+        if (rt > 0) {
+            return stalled();
+        }
+        if ((rt = head_check(&head)) != 0) {
+            return rt;
+        }
+    }
+
+    while (budget > 0) {
+        size_t want = g_probing ? sizeof(g_probe) - g_probe_len : sizeof(buf);
+        size_t got = 0;
+
+        if (want > budget) {
+            want = budget;
+        }
+        // The decoder knows new_size, so a body ending before the image
+        // is complete is a dropped connection, not a short patch
+        if (hal->http_get_read(g_stream, buf, want, &got) != 0) {
+            return retry_later("connection ended");
+        }
+        if (got == 0) {
+            return budget == OTA_POLL_BYTES ? stalled() : HS_OTA_BUSY;
+        }
+        budget -= got;
+        g_retries = 0;
+        g_stall_at = hal->now_ms() + OTA_STALL_MS;
+
+        if (g_probing) {
+            memcpy(g_probe + g_probe_len, buf, got);
+            g_probe_len += got;
+            if (g_probe_len < sizeof(g_probe)) {
+                continue;
+            }
+            if (probe_matches()) {
+                // Reconnect at the checkpoint with a Range request
+                HS_LOGI("OTA: resuming at patch offset %u", (unsigned)hs_delta_offset(&g_delta));
+                stream_close();
+                g_probing = 0;
+                return HS_OTA_BUSY;
+            }
+            HS_LOGI("OTA: patch changed since the checkpoint, restarting");
+            fresh_start();
+            rt = hs_delta_feed(&g_delta, g_probe, sizeof(g_probe));
+        } else {
+            rt = hs_delta_feed(&g_delta, buf, got);
+        }
+
+        if (rt == HS_DELTA_DONE) {
+            return install();
+        }
+        if (rt != HS_DELTA_OK) {
+            return fail(rt);
+        }
+    }
+    return HS_OTA_BUSY;
+}
+
+int hs_ota_busy(void)
+{
+    return g_phase != OTA_IDLE;
+}
+
+uint32_t hs_ota_wait_ms(void)
+{
+    int32_t left = 0;
+
+    if (g_phase == OTA_IDLE) {
+        return UINT32_MAX;
+    }
+    if (g_phase == OTA_BACKOFF) {
+        left = (int32_t)(g_retry_at - hs_hal()->now_ms());
+    } else if (g_starved) {
+        return HS_OTA_POLL_WAIT_MS;
+    }
+    return left > 0 ? (uint32_t)left : 0;
+}
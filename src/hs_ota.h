@@ -0,0 +1,95 @@
+/**
+ * @file hs_ota.h
+ * @brief HeySalad T5 Terminal - Delta OTA update
+ *
+ * Three flash regions, all taken from the platform partition table:
+ *   app      the running firmware as the bootloader installed it, only
+ *            fingerprinted to tell whether an install happened (read only)
+ *   pkgs     two slots of firmware packages, in the format the bootloader
+ *            takes: A, the package the running firmware came from, and B,
+ *            where the next one is staged. They swap roles on each install
+ *   meta     HS_OTA_META_SECTORS holding the boot control record and the
+ *            download checkpoint, each double buffered across two sectors
+ *
+ * An update is a delta (see hs_delta.h) against the running firmware's
+ * package, streamed into the other slot over a single HTTP connection,
+ * verified, then handed to the bootloader through hal->ota_install(). A
+ * unit flashed over USB keeps no package, so its first update is a full
+ * package (a delta with old_size 0). The download runs in slices from
+ * hs_ota_poll() over the non-blocking GET of the HAL, so the main loop and
+ * the button stay live throughout, also while the network stalls. A
+ * connection that fails or closes before the image is complete, including
+ * a body that simply ends, is retried from the last checkpoint.
+ *
+ * After the reset the new image must call hs_ota_mark_boot_ok() once it is
+ * healthy. After OTA_MAX_BOOT_ATTEMPTS unconfirmed boots the package of the
+ * previous firmware, still in its slot, is handed to the bootloader again.
+ * Only the first update after a USB flash has nothing to roll back to.
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#ifndef HS_OTA_H
+#define HS_OTA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hs_flash.h"
+
+#define HS_OTA_META_SECTORS     4
+#define HS_OTA_POLL_WAIT_MS     50          // Poll interval while no bytes are waiting
+
+// hs_ota_poll() results
+#define HS_OTA_IDLE             0           // Nothing in progress
+#define HS_OTA_BUSY             1           // Downloading or waiting to retry
+#define HS_OTA_STAGED           2           // Installed on the next reset
+#define HS_OTA_FAILED           -1
+
+/**
+ * @brief Load the boot control record and roll back a failing update
+ *
+ * Call first thing at boot. May not return if a rollback reset is needed.
+ *
+ * @return 0 when the running firmware's package is usable as a delta base
+ */
+int hs_ota_init(const hs_flash_region_t *app, const hs_flash_region_t *pkgs,
+                const hs_flash_region_t *meta);
+
+/**
+ * @brief Confirm the running image, cancelling any pending rollback
+ */
+void hs_ota_mark_boot_ok(void);
+
+/**
+ * @brief Begin downloading a delta, or resume the checkpointed one
+ *
+ * A checkpoint is only resumed when url, the patch header (old_crc and
+ * new_crc) and the running image all still match it. Nothing happens
+ * until hs_ota_poll() is called.
+ *
+ * @return 0 if started or already running, -1 if updates are not possible
+ */
+int hs_ota_start(const char *url);
+
+/**
+ * @brief Advance the download by at most OTA_POLL_BYTES, never blocks on retries
+ *
+ * @return HS_OTA_BUSY while in progress, HS_OTA_STAGED once the verified
+ *         image is with the bootloader, HS_OTA_FAILED or HS_OTA_IDLE
+ */
+int hs_ota_poll(void);
+
+/**
+ * @brief Whether a download is in progress
+ */
+int hs_ota_busy(void);
+
+/**
+ * @brief Time until hs_ota_poll() has work: 0 while streaming, at most
+ *        HS_OTA_POLL_WAIT_MS while waiting for the network, the remaining
+ *        backoff while waiting to retry, UINT32_MAX when idle
+ */
+uint32_t hs_ota_wait_ms(void);
+
+#endif // HS_OTA_H
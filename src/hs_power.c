@@ -0,0 +1,176 @@
+/**
+ * @file hs_power.c
+ * @brief HeySalad T5 Terminal - Power manager
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#include "hs_power.h"
+
+#include <string.h>
+
+#include "heysalad_config.h"
+
+static const hs_power_ops_t *g_ops = NULL;
+static hs_power_stats_t g_stats;
+
+static uint32_t g_last_ts = 0;          // Last time accounting ran
+static uint32_t g_last_activity = 0;
+static int g_hold = 0;
+
+// Wake slot, shared by interrupt context and the main task (through
+// hs_power_hold), so it is claimed with a compare-and-swap
+#define WAKE_FREE       0
+#define WAKE_CLAIMED    1       // Being filled in, not yet visible to poll
+#define WAKE_PENDING    2
+
+static int g_wake_slot = WAKE_FREE;
+static uint32_t g_wake_time = 0;
+static hs_power_wake_t g_wake_src = HS_POWER_WAKE_APP;
+
+static const uint32_t g_state_ma[HS_POWER_STATE_MAX] = {
+    POWER_MA_ACTIVE,
+    POWER_MA_IDLE,
+    POWER_MA_SLEEP,
+};
+
+static const uint32_t g_state_wait_ms[HS_POWER_STATE_MAX] = {
+    POWER_POLL_ACTIVE_MS,
+    POWER_POLL_IDLE_MS,
+    POWER_POLL_SLEEP_MS,
+};
+
+static void account(uint32_t now)
+{
+    uint32_t dt = now - g_last_ts;
+
+    g_stats.time_ms[g_stats.state] += dt;
+    g_stats.charge_mams += (uint64_t)dt * g_state_ma[g_stats.state];
+    g_last_ts = now;
+}
+
+static void set_state(hs_power_state_t state)
+{
+    if (state == g_stats.state) {
+        return;
+    }
+    g_stats.state = state;
+    g_ops->enter(state);
+}
+
+void hs_power_init(const hs_power_ops_t *ops)
+{
+    g_ops = ops;
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_stats.state = HS_POWER_ACTIVE;
+    g_hold = 0;
+    __atomic_store_n(&g_wake_slot, WAKE_FREE, __ATOMIC_RELEASE);
+    g_last_ts = ops->now_ms();
+    g_last_activity = g_last_ts;
+    ops->enter(HS_POWER_ACTIVE);
+}
+
+void hs_power_wake(hs_power_wake_t src)
+{
+    int expected = WAKE_FREE;
+
+    if (!g_ops || src >= HS_POWER_WAKE_MAX) {
+        return;
+    }
+    // Keep the earliest unserviced event, latency is measured from it. A
+    // wake that finds the slot taken is merged into the one already there
+    if (!__atomic_compare_exchange_n(&g_wake_slot, &expected, WAKE_CLAIMED, 0,
+                                     __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return;
+    }
+    g_wake_time = g_ops->now_ms();
+    g_wake_src = src;
+    __atomic_store_n(&g_wake_slot, WAKE_PENDING, __ATOMIC_RELEASE);
+}
+
+void hs_power_hold(int hold)
+{
+    if (!g_ops) {
+        return;
+    }
+    if (hold) {
+        g_hold++;
+        // Apply now, the held work runs before the next poll
+        hs_power_wake(HS_POWER_WAKE_APP);
+        hs_power_poll();
+    } else if (g_hold > 0) {
+        g_hold--;
+        g_last_activity = g_ops->now_ms();
+    }
+}
+
+hs_power_state_t hs_power_poll(void)
+{
+    uint32_t now = 0;
+
+    if (!g_ops) {
+        return HS_POWER_ACTIVE;
+    }
+    now = g_ops->now_ms();
+    account(now);
+
+    if (__atomic_load_n(&g_wake_slot, __ATOMIC_ACQUIRE) == WAKE_PENDING) {
+        uint32_t t = g_wake_time;
+        hs_power_wake_t src = g_wake_src;
+
+        __atomic_store_n(&g_wake_slot, WAKE_FREE, __ATOMIC_RELEASE);
+        g_last_activity = now;
+        g_stats.wakes[src]++;
+
+        if (g_stats.state != HS_POWER_ACTIVE) {
+            set_state(HS_POWER_ACTIVE);
+            g_stats.last_wake_ms = g_ops->now_ms() - t;
+            if (g_stats.last_wake_ms > g_stats.max_wake_ms) {
+                g_stats.max_wake_ms = g_stats.last_wake_ms;
+            }
+            if (g_stats.last_wake_ms > POWER_WAKE_TARGET_MS) {
+                g_stats.slow_wakes++;
+            }
+        }
+        return g_stats.state;
+    }
+
+    if (g_hold > 0) {
+        g_last_activity = now;
+        set_state(HS_POWER_ACTIVE);
+        return g_stats.state;
+    }
+
+    // Only ever step down here, waking is done above
+    uint32_t quiet = now - g_last_activity;
+    if (quiet >= POWER_SLEEP_TIMEOUT_MS) {
+        set_state(HS_POWER_SLEEP);
+    } else if (quiet >= POWER_IDLE_TIMEOUT_MS && g_stats.state == HS_POWER_ACTIVE) {
+        set_state(HS_POWER_IDLE);
+    }
+    return g_stats.state;
+}
+
+uint32_t hs_power_wait_ms(void)
+{
+    return g_state_wait_ms[g_stats.state];
+}
+
+void hs_power_get_stats(hs_power_stats_t *stats)
+{
+    if (g_ops) {
+        account(g_ops->now_ms());
+    }
+    memcpy(stats, &g_stats, sizeof(*stats));
+}
+
+uint32_t hs_power_state_ma(hs_power_state_t state)
+{
+    return state < HS_POWER_STATE_MAX ? g_state_ma[state] : 0;
+}
+
+const char *hs_power_state_name(hs_power_state_t state)
+{
+    static const char *names[HS_POWER_STATE_MAX] = { "active", "idle", "sleep" };
+    return state < HS_POWER_STATE_MAX ? names[state] : "?";
+}
@@ -0,0 +1,99 @@
+/**
+ * @file hs_power.h
+ * @brief HeySalad T5 Terminal - Power manager
+ *
+ * Three states, stepped down by inactivity and back up by any wake event:
+ *
+ *   ACTIVE  CPU running, Wi-Fi full power          (recording, HTTP calls)
+ *   IDLE    CPU sleeps between ticks, Wi-Fi DTIM 1 (just finished a request)
+ *   SLEEP   as IDLE, Wi-Fi DTIM 3, 1 s loop tick   (waiting for the merchant)
+ *
+ * IDLE and SLEEP use the same CPU sleep; SLEEP saves by listening to fewer
+ * beacons and waking the main loop less often. Deeper CPU sleep would drop
+ * the Wi-Fi association and miss POWER_WAKE_TARGET_MS.
+ *
+ * The state machine only sees a clock and an enter() hook, so it runs the
+ * same against the real tick counter or a simulated one. Wake events may be
+ * raised from interrupt context; the main loop applies them in
+ * hs_power_poll(), which also measures wake latency.
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#ifndef HS_POWER_H
+#define HS_POWER_H
+
+#include <stdint.h>
+
+typedef enum {
+    HS_POWER_ACTIVE = 0,
+    HS_POWER_IDLE,
+    HS_POWER_SLEEP,
+    HS_POWER_STATE_MAX
+} hs_power_state_t;
+
+typedef enum {
+    HS_POWER_WAKE_BUTTON = 0,
+    HS_POWER_WAKE_NET,          // Packet on the push channel / link event
+    HS_POWER_WAKE_APP,          // Timer or application request
+    HS_POWER_WAKE_MAX
+} hs_power_wake_t;
+
+typedef struct {
+    uint32_t (*now_ms)(void);
+    void (*enter)(hs_power_state_t state);  // Apply CPU / Wi-Fi settings
+} hs_power_ops_t;
+
+typedef struct {
+    hs_power_state_t state;
+    uint32_t time_ms[HS_POWER_STATE_MAX];   // Time spent per state
+    uint64_t charge_mams;                   // Estimated charge, mA * ms
+    uint32_t wakes[HS_POWER_WAKE_MAX];
+    uint32_t last_wake_ms;                  // Wake event to ACTIVE restored
+    uint32_t max_wake_ms;
+    uint32_t slow_wakes;                    // Over POWER_WAKE_TARGET_MS
+} hs_power_stats_t;
+
+/**
+ * @brief Start in ACTIVE, calls ops->enter(HS_POWER_ACTIVE)
+ */
+void hs_power_init(const hs_power_ops_t *ops);
+
+/**
+ * @brief Record a wake event, safe from interrupt context
+ */
+void hs_power_wake(hs_power_wake_t src);
+
+/**
+ * @brief Keep the terminal ACTIVE while held (recording, network calls)
+ *
+ * Call from the main loop; holding switches to ACTIVE straight away.
+ */
+void hs_power_hold(int hold);
+
+/**
+ * @brief Apply pending wakes and inactivity timeouts, call from the main loop
+ */
+hs_power_state_t hs_power_poll(void);
+
+/**
+ * @brief How long the main loop may block before the next hs_power_poll()
+ */
+uint32_t hs_power_wait_ms(void);
+
+/**
+ * @brief Snapshot of accumulated statistics, up to date as of the call
+ */
+void hs_power_get_stats(hs_power_stats_t *stats);
+
+/**
+ * @brief Estimated current draw of a state in mA
+ */
+uint32_t hs_power_state_ma(hs_power_state_t state);
+
+/**
+ * @brief State name for logs
+ */
+const char *hs_power_state_name(hs_power_state_t state);
+
+#endif // HS_POWER_H
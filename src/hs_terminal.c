@@ -0,0 +1,786 @@
+/**
+ * @file hs_terminal.c
+ * @brief HeySalad T5 Terminal - Terminal core
+ *
+ * Voice-enabled payment terminal for HeySalad
+ * - Push-to-talk voice commands
+ * - QR code payment generation
+ * - Audio feedback via TTS
+ * - WiFi connectivity to HeySalad cloud
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#include "hs_terminal.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "heysalad_config.h"
+#include "hs_hal.h"
+#include "hs_flash.h"
+#include "hs_cfg.h"
+#include "hs_ota.h"
+#include "hs_power.h"
+#include "hs_ledger.h"
+#include "hs_metrics.h"
+
+static const hs_hal_t *g_hal = NULL;
+
+// State
+static volatile int g_wifi_connected = 0;
+static volatile int g_button_pressed = 0;
+static volatile int g_recording = 0;
+static volatile int g_wifi_was_up = 0;
+
+// Audio buffer, also holds fetched speech while nothing is recording
+#define AUDIO_BUFFER_MAX (16000 * 5)  // 5 seconds at 16kHz
+static uint8_t g_audio_buffer[AUDIO_BUFFER_MAX];
+static size_t g_audio_len = 0;
+
+// Flash regions, placed from the platform partition table at init
+static hs_flash_region_t g_app_region;
+static hs_flash_region_t g_pkg_region;
+static hs_flash_region_t g_ota_region;
+static hs_flash_region_t g_cfg_region;
+static hs_flash_region_t g_ledger_region;
+
+// Telemetry batch waiting to ride along with the next bridge request
+static char g_metrics_batch[METRICS_BATCH_MAX];
+static int g_metrics_ready = 0;
+static uint32_t g_metrics_ready_since = 0;
+
+// Main loop timers
+static uint32_t g_last_ota_check = 0;
+static uint32_t g_last_power_report = 0;
+static uint32_t g_last_reconcile = 0;
+static uint32_t g_reconcile_after = 0;  // Last txn asked about, the next run goes on from there
+static uint32_t g_last_metrics = 0;
+static int g_ota_held = 0;
+
+/**
+ * @brief Power manager clock
+ */
+static uint32_t power_now_ms(void)
+{
+    return g_hal->now_ms();
+}
+
+/**
+ * @brief Apply CPU and WiFi power settings for a power state
+ */
+static void power_enter(hs_power_state_t state)
+{
+    g_hal->power(state);
+    HS_LOGD("Power: %s (~%u mA)", hs_power_state_name(state), (unsigned)hs_power_state_ma(state));
+}
+
+static const hs_power_ops_t g_power_ops = {
+    .now_ms = power_now_ms,
+    .enter = power_enter,
+};
+
+/**
+ * @brief Log time per power state, estimated draw and wake latency
+ */
+static void power_report(void)
+{
+    hs_power_stats_t st;
+    hs_power_get_stats(&st);
+
+    uint32_t total = st.time_ms[HS_POWER_ACTIVE] + st.time_ms[HS_POWER_IDLE] + st.time_ms[HS_POWER_SLEEP];
+    uint32_t avg_ma = total ? (uint32_t)(st.charge_mams / total) : 0;
+
+    HS_LOGI("Power: active %us idle %us sleep %us, avg ~%u mA",
+        (unsigned)(st.time_ms[HS_POWER_ACTIVE] / 1000), (unsigned)(st.time_ms[HS_POWER_IDLE] / 1000),
+        (unsigned)(st.time_ms[HS_POWER_SLEEP] / 1000), (unsigned)avg_ma);
+    HS_LOGI("Power: wakes button %u net %u, latency last %u ms max %u ms, %u over %u ms",
+        (unsigned)st.wakes[HS_POWER_WAKE_BUTTON], (unsigned)st.wakes[HS_POWER_WAKE_NET],
+        (unsigned)st.last_wake_ms, (unsigned)st.max_wake_ms,
+        (unsigned)st.slow_wakes, (unsigned)POWER_WAKE_TARGET_MS);
+}
+
+/**
+ * @brief Copy the string value of "key" out of a flat JSON response
+ */
+static int json_get_string(const char *json, const char *key, char *out, size_t out_len)
+{
+    char pattern[40];
+    snprintf(pattern, sizeof(pattern), "\"%s\":\"", key);
+
+    const char *start = strstr(json, pattern);
+    if (!start) {
+        return -1;
+    }
+    start += strlen(pattern);
+    const char *end = strchr(start, '"');
+    if (!end || (size_t)(end - start) >= out_len) {
+        return -1;
+    }
+    memcpy(out, start, end - start);
+    out[end - start] = '\0';
+    return 0;
+}
+
+/**
+ * @brief HTTP POST request helper, binary response of up to resp_max bytes
+ *
+ * Every request goes through here so it is counted in the HTTP latency
+ * and error metrics.
+ */
+static int http_post_raw(const char *url, const char *content_type,
+                         const uint8_t *body, size_t body_len,
+                         uint8_t *resp, size_t resp_max, size_t *resp_len)
+{
+    const char *headers[5] = { NULL };
+    uint32_t start = g_hal->now_ms();
+
+    // Piggy-back pending telemetry on a request the radio is sending anyway
+    const char *bridge = hs_cfg()->bridge_url;
+    int with_metrics = g_metrics_ready && strncmp(url, bridge, strlen(bridge)) == 0;
+    if (with_metrics) {
+        headers[0] = "X-HS-Device";
+        headers[1] = hs_cfg()->device_id;
+        headers[2] = "X-HS-Metrics";
+        headers[3] = g_metrics_batch;
+    }
+
+    int ret = g_hal->http_post(url, content_type, headers, body, body_len, resp, resp_max, resp_len);
+    hs_metrics_observe(HS_METRIC_HTTP_POST_MS, g_hal->now_ms() - start);
+    if (ret != 0) {
+        hs_metrics_inc(HS_METRIC_HTTP_ERRORS);
+        return ret;
+    }
+    if (with_metrics) {
+        hs_metrics_ack();
+        g_metrics_ready = 0;
+    }
+    return 0;
+}
+
+/**
+ * @brief HTTP POST request helper, response is NUL terminated text
+ */
+static int http_post(const char *url, const char *content_type,
+                     const uint8_t *body, size_t body_len,
+                     char *response, size_t response_max)
+{
+    size_t resp_len = 0;
+    int ret = http_post_raw(url, content_type, body, body_len,
+                            (uint8_t *)response, response ? response_max - 1 : 0, &resp_len);
+
+    if (ret == 0 && response) {
+        response[resp_len < response_max - 1 ? resp_len : response_max - 1] = '\0';
+    }
+    return ret;
+}
+
+/**
+ * @brief Ask the bridge for a delta against the running firmware
+ *
+ * Only starts the download; hs_ota_poll() does the work from the main loop.
+ */
+static void ota_check_for_update(void)
+{
+    char url[256];
+    snprintf(url, sizeof(url), "%s/api/ota/check", hs_cfg()->bridge_url);
+
+    char body[256];
+    snprintf(body, sizeof(body),
+        "{\"device_id\":\"%s\",\"version\":\"%s\"}",
+        hs_cfg()->device_id, HEYSALAD_FW_VERSION);
+
+    char response[512] = {0};
+    if (http_post(url, "application/json", (uint8_t *)body, strlen(body), response, sizeof(response)) != 0) {
+        return;
+    }
+
+    // Parse patch URL from response, absent when up to date
+    char patch_url[256] = {0};
+    if (json_get_string(response, "patch_url", patch_url, sizeof(patch_url)) != 0) {
+        return;
+    }
+
+    HS_LOGI("OTA: update available: %s", patch_url);
+    hs_ota_start(patch_url);
+}
+
+/**
+ * @brief Run one slice of a firmware download
+ */
+static void ota_step(void)
+{
+    int rt = hs_ota_poll();
+
+    if (rt == HS_OTA_STAGED) {
+        HS_LOGI("OTA: rebooting into new firmware");
+        g_hal->sleep_ms(100);
+        g_hal->reset();
+    }
+
+    // Stay ACTIVE while bytes flow; retry backoff may sleep
+    int downloading = rt == HS_OTA_BUSY && hs_ota_wait_ms() <= HS_OTA_POLL_WAIT_MS;
+    if (downloading != g_ota_held) {
+        hs_power_hold(downloading);
+        g_ota_held = downloading;
+    }
+}
+
+/**
+ * @brief Carve the terminal regions out of the platform partitions
+ *
+ * The data partition holds, in order: OTA records, config store, ledger.
+ */
+static int storage_init(void)
+{
+    hs_flash_region_t *part[HS_PART_MAX] = { &g_app_region, &g_pkg_region, &g_ota_region };
+    uint32_t base = 0, size = 0;
+    uint32_t need = (HS_OTA_META_SECTORS + CFG_STORE_SECTORS + LEDGER_SECTORS) * FLASH_SECTOR_SIZE;
+
+    for (int i = 0; i < HS_PART_MAX; i++) {
+        if (!g_hal->partition || g_hal->partition((hs_part_t)i, &base, &size) != 0 ||
+            (base % FLASH_SECTOR_SIZE) != 0) {
+            HS_LOGE("Flash: partition %d missing", i);
+            return -1;
+        }
+        part[i]->ops = g_hal->flash;
+        part[i]->ctx = g_hal->flash_ctx;
+        part[i]->base = base;
+        part[i]->size = size - size % FLASH_SECTOR_SIZE;
+        part[i]->sector_size = FLASH_SECTOR_SIZE;
+    }
+
+    if (g_ota_region.size < need) {
+        HS_LOGE("Flash: data partition %u bytes, need %u", (unsigned)g_ota_region.size, (unsigned)need);
+        return -1;
+    }
+    g_cfg_region = g_ota_region;
+    g_ledger_region = g_ota_region;
+    g_ota_region.size = HS_OTA_META_SECTORS * FLASH_SECTOR_SIZE;
+    g_cfg_region.base += g_ota_region.size;
+    g_cfg_region.size = CFG_STORE_SECTORS * FLASH_SECTOR_SIZE;
+    g_ledger_region.base = g_cfg_region.base + g_cfg_region.size;
+    g_ledger_region.size = LEDGER_SECTORS * FLASH_SECTOR_SIZE;
+    return 0;
+}
+
+/**
+ * @brief Send voice to HeySalad cloud
+ */
+static int send_voice_to_cloud(const uint8_t *audio, size_t len, char *response, size_t response_len)
+{
+    char url[256];
+    snprintf(url, sizeof(url), "%s/api/voice/chat", hs_cfg()->bridge_url);
+
+    uint32_t start = g_hal->now_ms();
+    int ret = http_post(url, "audio/wav", audio, len, response, response_len);
+    hs_metrics_observe(HS_METRIC_VOICE_MS, g_hal->now_ms() - start);
+    if (ret != 0) {
+        hs_metrics_inc(HS_METRIC_VOICE_ERRORS);
+    }
+    return ret;
+}
+
+/**
+ * @brief Create payment via HeySalad API
+ */
+static int create_payment(float amount, const char *currency, char *qr_url, size_t url_len)
+{
+    char url[256];
+    snprintf(url, sizeof(url), "%s/api/payment/create", hs_cfg()->bridge_url);
+
+    char body[256];
+    snprintf(body, sizeof(body),
+        "{\"amount\":%.2f,\"currency\":\"%s\",\"device_id\":\"%s\"}",
+        amount, currency, hs_cfg()->device_id);
+
+    char response[1024] = {0};
+    uint32_t start = g_hal->now_ms();
+    int ret = http_post(url, "application/json", (uint8_t *)body, strlen(body), response, sizeof(response));
+    hs_metrics_observe(HS_METRIC_PAYMENT_MS, g_hal->now_ms() - start);
+
+    if (ret == 0 && json_get_string(response, "qr_url", qr_url, url_len) == 0) {
+        // Record locally so history queries need no round trip
+        char payment_id[HS_LEDGER_REF_MAX] = {0};
+        if (json_get_string(response, "payment_id", payment_id, sizeof(payment_id)) != 0 ||
+            payment_id[0] == '\0') {
+            // Nothing to reconcile it by, it would stay pending for ever
+            HS_LOGE("Payment: no payment_id, not recorded");
+            return 0;
+        }
+        hs_ledger_add(g_hal->time_s(), (int32_t)(amount * 100.0f + 0.5f),
+                      currency, payment_id, HS_LEDGER_PENDING, NULL);
+        return 0;
+    }
+
+    hs_metrics_inc(HS_METRIC_PAYMENT_ERRORS);
+    return -1;
+}
+
+/**
+ * @brief Apply a payment status update to the ledger
+ *
+ * Takes {"payment_id":"...","status":"paid|failed|expired|pending"}, as sent
+ * by the bridge for status queries and settlement notifications.
+ */
+static int ledger_apply_status(const char *json)
+{
+    char payment_id[HS_LEDGER_REF_MAX];
+    char status[16];
+    hs_ledger_status_t st;
+
+    if (json_get_string(json, "payment_id", payment_id, sizeof(payment_id)) != 0 ||
+        json_get_string(json, "status", status, sizeof(status)) != 0) {
+        return -1;
+    }
+
+    if (strcmp(status, "paid") == 0) {
+        st = HS_LEDGER_PAID;
+    } else if (strcmp(status, "failed") == 0) {
+        st = HS_LEDGER_FAILED;
+    } else if (strcmp(status, "expired") == 0) {
+        st = HS_LEDGER_EXPIRED;
+    } else {
+        return 0;  // Still pending
+    }
+
+    HS_LOGI("Ledger: %s -> %s", payment_id, status);
+    return hs_ledger_update(payment_id, st, 1);
+}
+
+/**
+ * @brief Ask the bridge about payments still pending locally
+ *
+ * Each run takes LEDGER_RECONCILE_BATCH entries on from where the last one
+ * stopped, wrapping around, so old entries cannot starve newer ones. A
+ * payment older than PAYMENT_TIMEOUT_SEC the bridge still has no answer
+ * for is expired locally, unsynced, so a late settlement still applies
+ * but the terminal stops waking the radio for it.
+ */
+static void ledger_reconcile(void)
+{
+    hs_ledger_entry_t e, cur;
+    uint32_t start = g_reconcile_after;
+    uint32_t now = g_hal->time_s();
+    int wrapped = 0;
+    int budget = LEDGER_RECONCILE_BATCH;
+
+    char url[256];
+    snprintf(url, sizeof(url), "%s/api/payment/status", hs_cfg()->bridge_url);
+
+    while (budget > 0) {
+        if (hs_ledger_next_pending(g_reconcile_after, &e) != 0 || (wrapped && e.txn > start)) {
+            if (wrapped || start == 0) {
+                g_reconcile_after = 0;
+                break;
+            }
+            wrapped = 1;
+            g_reconcile_after = 0;
+            continue;
+        }
+        g_reconcile_after = e.txn;
+        budget--;
+
+        char payment_id[HS_LEDGER_REF_MAX] = {0};
+        if (hs_ledger_ref(&e, payment_id, sizeof(payment_id)) != 0 || payment_id[0] == '\0') {
+            // Recorded by older firmware, the bridge cannot be asked about it
+            hs_ledger_update_txn(e.txn, HS_LEDGER_EXPIRED, 0);
+            continue;
+        }
+
+        char body[128];
+        snprintf(body, sizeof(body), "{\"payment_id\":\"%s\"}", payment_id);
+
+        char response[256] = {0};
+        if (http_post(url, "application/json", (uint8_t *)body, strlen(body), response, sizeof(response)) == 0) {
+            ledger_apply_status(response);
+        }
+
+        // Creation times from before SNTP say nothing about age
+        if (now >= CLOCK_VALID_AFTER_S && e.ts >= CLOCK_VALID_AFTER_S && now - e.ts >= PAYMENT_TIMEOUT_SEC &&
+            hs_ledger_next_pending(e.txn - 1, &cur) == 0 && cur.txn == e.txn) {
+            HS_LOGI("Ledger: %s timed out, expired locally", payment_id);
+            hs_ledger_update_txn(e.txn, HS_LEDGER_EXPIRED, 0);
+        }
+    }
+}
+
+/**
+ * @brief Play TTS audio
+ */
+static void play_tts(const char *text)
+{
+    HS_LOGI("TTS: %s", text);
+
+    if (!g_hal->audio_play || g_recording) {
+        return;
+    }
+
+    char url[256];
+    snprintf(url, sizeof(url), "%s/api/voice/speak", hs_cfg()->voice_url);
+
+    char body[512];
+    snprintf(body, sizeof(body), "{\"text\":\"%s\"}", text);
+
+    size_t len = 0;
+    if (http_post_raw(url, "application/json", (uint8_t *)body, strlen(body),
+                      g_audio_buffer, sizeof(g_audio_buffer), &len) == 0 && len > 0) {
+        g_hal->audio_play(g_audio_buffer, len < sizeof(g_audio_buffer) ? len : sizeof(g_audio_buffer));
+    }
+}
+
+/**
+ * @brief Start of the local day containing now, as UTC seconds
+ */
+static uint32_t local_day_start(uint32_t now)
+{
+    int32_t offset = hs_cfg()->utc_offset_min * 60;
+    uint32_t local = now + offset;
+
+    return local - local % 86400 - offset;
+}
+
+/**
+ * @brief Answer "check balance" from the local ledger
+ *
+ * Before SNTP has set the clock there is no "today"; the answer is then
+ * qualified as the total of everything in the ledger.
+ */
+static void answer_balance(void)
+{
+    uint32_t now = g_hal->time_s();
+    uint32_t count = 0;
+    int64_t sum = 0;
+    char text[128];
+
+    if (now < CLOCK_VALID_AFTER_S) {
+        hs_ledger_totals(HS_LEDGER_PAID, 0, &count, &sum);
+        snprintf(text, sizeof(text), "Clock not set yet. In total you received %u payments, total %d.%02d %s",
+            (unsigned)count, (int)(sum / 100), (int)(sum % 100), hs_cfg()->currency);
+    } else {
+        hs_ledger_totals(HS_LEDGER_PAID, local_day_start(now), &count, &sum);
+        snprintf(text, sizeof(text), "Today you received %u payments, total %d.%02d %s",
+            (unsigned)count, (int)(sum / 100), (int)(sum % 100), hs_cfg()->currency);
+    }
+    play_tts(text);
+}
+
+/**
+ * @brief Answer "last payment" from the local ledger
+ */
+static void answer_last_payment(void)
+{
+    hs_ledger_entry_t e;
+
+    if (hs_ledger_last(HS_LEDGER_PAID, &e) != 0) {
+        play_tts("No payments received yet");
+        return;
+    }
+
+    char text[128];
+    snprintf(text, sizeof(text), "Last payment was %d.%02d %s",
+        (int)(e.amount / 100), (int)(e.amount % 100), e.currency);
+    play_tts(text);
+}
+
+/**
+ * @brief Process voice response
+ */
+static void process_voice_response(const char *response)
+{
+    HS_LOGI("Processing response: %s", response);
+
+    // Check for payment action
+    if (strstr(response, "\"action\":\"payment\"") != NULL) {
+        char *amount_str = strstr(response, "\"amount\":");
+        if (amount_str) {
+            float amount = atof(amount_str + 9);
+
+            char qr_url[256] = {0};
+            if (create_payment(amount, hs_cfg()->currency, qr_url, sizeof(qr_url)) == 0) {
+                HS_LOGI("Payment QR: %s", qr_url);
+                g_hal->led(HS_LED_SUCCESS);
+                play_tts("Payment created. Customer can scan the QR code.");
+            } else {
+                g_hal->led(HS_LED_ERROR);
+                play_tts("Failed to create payment");
+            }
+        }
+    }
+    // History queries are answered from the local ledger
+    else if (strstr(response, "\"action\":\"balance\"") != NULL) {
+        answer_balance();
+    }
+    else if (strstr(response, "\"action\":\"last_payment\"") != NULL) {
+        answer_last_payment();
+    }
+    // Settlement notification relayed with the reply
+    else if (strstr(response, "\"action\":\"payment_status\"") != NULL) {
+        ledger_apply_status(response);
+    }
+    // Check for text response
+    else {
+        char text[512] = {0};
+        if (json_get_string(response, "text", text, sizeof(text)) == 0) {
+            play_tts(text);
+        }
+    }
+}
+
+/**
+ * @brief Close the current telemetry period into a batch for upload
+ */
+static void metrics_collect(void)
+{
+    if (g_hal->free_heap) {
+        hs_metrics_set(HS_METRIC_HEAP_FREE, (int32_t)g_hal->free_heap());
+    }
+    hs_metrics_set(HS_METRIC_LEDGER_TXNS, (int32_t)hs_ledger_count());
+
+    int n = hs_metrics_batch(g_hal->now_ms(), g_metrics_batch, sizeof(g_metrics_batch));
+    if (n < 0) {
+        // Cannot happen with sane counts; drop the period rather than stall
+        HS_LOGE("Metrics: batch over %d bytes, dropped", METRICS_BATCH_MAX);
+        hs_metrics_ack();
+        g_metrics_ready = 0;
+    } else if (n > 0 && !g_metrics_ready) {
+        g_metrics_ready = 1;
+        g_metrics_ready_since = g_hal->now_ms();
+    }
+}
+
+/**
+ * @brief Upload telemetry on its own when no request has carried it
+ */
+static void metrics_flush(void)
+{
+    char url[256];
+    snprintf(url, sizeof(url), "%s/api/telemetry", hs_cfg()->bridge_url);
+
+    char body[64];
+    snprintf(body, sizeof(body), "{\"device_id\":\"%s\"}", hs_cfg()->device_id);
+
+    // http_post() attaches the batch as a header
+    http_post(url, "application/json", (uint8_t *)body, strlen(body), NULL, 0);
+}
+
+/**
+ * @brief Move captured audio into the recording buffer
+ */
+static void audio_capture(void)
+{
+    uint8_t scratch[256];
+
+    if (!g_hal->audio_read) {
+        return;
+    }
+    if (g_audio_len < sizeof(g_audio_buffer)) {
+        g_audio_len += g_hal->audio_read(g_audio_buffer + g_audio_len, sizeof(g_audio_buffer) - g_audio_len);
+    } else if (g_hal->audio_read(scratch, sizeof(scratch)) > 0) {
+        // Buffer full, the rest of the utterance is lost
+        hs_metrics_inc(HS_METRIC_AUDIO_OVERRUNS);
+    }
+}
+
+// ============================================
+// Public API
+// ============================================
+
+void hs_terminal_button(int pressed)
+{
+    g_button_pressed = pressed;
+    hs_power_wake(HS_POWER_WAKE_BUTTON);
+}
+
+void hs_terminal_link(int up)
+{
+    hs_power_wake(HS_POWER_WAKE_NET);
+
+    if (up) {
+        HS_LOGI("WiFi connected!");
+        if (g_wifi_was_up) {
+            hs_metrics_inc(HS_METRIC_WIFI_RECONNECTS);
+        }
+        g_wifi_was_up = 1;
+        g_wifi_connected = 1;
+        g_hal->led(HS_LED_SUCCESS);
+    } else {
+        HS_LOGI("WiFi disconnected");
+        g_wifi_connected = 0;
+        g_hal->led(HS_LED_ERROR);
+    }
+}
+
+int hs_terminal_console(const char *line, char *reply, size_t len)
+{
+    return hs_cfg_provision_line(line, reply, len);
+}
+
+int hs_terminal_init(const hs_hal_t *hal)
+{
+    g_hal = hal;
+    hs_hal_set(hal);
+
+    HS_LOGI("========================================");
+    HS_LOGI("HeySalad T5 Voice Terminal v1.0");
+    HS_LOGI("========================================");
+
+    if (storage_init() != 0) {
+        return -1;
+    }
+
+    // Roll back a failed update before touching anything else
+    hs_ota_init(&g_app_region, &g_pkg_region, &g_ota_region);
+
+    // Load credentials and endpoints, factory defaults if never provisioned
+    if (hs_cfg_init(&g_cfg_region) != 0) {
+        HS_LOGI("Config: not provisioned, using defaults");
+    }
+    HS_LOGI("Device ID: %s", hs_cfg()->device_id);
+
+    hs_metrics_init(hal->now_ms());
+    hs_ledger_init(&g_ledger_region);
+    HS_LOGI("Ledger: %u transactions", (unsigned)hs_ledger_count());
+    return 0;
+}
+
+int hs_terminal_start(void)
+{
+    const hs_cfg_t *cfg = hs_cfg();
+
+    g_hal->led(HS_LED_PROCESSING);
+
+    // Connect to WiFi
+    HS_LOGI("Connecting to WiFi: %s", cfg->wifi_ssid);
+    g_hal->net_connect(cfg->wifi_ssid, cfg->wifi_pass);
+
+    // Wait for WiFi
+    int timeout = cfg->wifi_timeout_ms / 100;
+    while (!g_wifi_connected && timeout > 0) {
+        g_hal->sleep_ms(100);
+        timeout--;
+    }
+
+    if (!g_wifi_connected) {
+        HS_LOGE("WiFi connection failed!");
+        g_hal->led(HS_LED_ERROR);
+        return -1;
+    }
+
+    // Network works, so this image can fetch its own fix if needed
+    hs_ota_mark_boot_ok();
+
+    g_hal->led(HS_LED_IDLE);
+    play_tts("HeySalad terminal ready");
+
+    ota_check_for_update();
+    g_last_ota_check = g_hal->now_ms();
+    g_last_power_report = g_last_ota_check;
+    g_last_reconcile = g_last_ota_check;
+    g_last_metrics = g_last_ota_check;
+
+    hs_power_init(&g_power_ops);
+
+    HS_LOGI("Entering main loop - press button to speak");
+    return 0;
+}
+
+void hs_terminal_step(void)
+{
+    hs_power_poll();
+
+    if (g_recording) {
+        audio_capture();
+    }
+
+    if (g_button_pressed && !g_recording) {
+        // Start recording
+        hs_power_hold(1);
+        g_recording = 1;
+        g_audio_len = 0;
+        g_hal->led(HS_LED_LISTENING);
+        HS_LOGI("Recording started...");
+        if (g_hal->audio_start) {
+            g_hal->audio_start();
+        }
+    }
+    else if (!g_button_pressed && g_recording) {
+        // Stop recording and process
+        if (g_hal->audio_stop) {
+            audio_capture();
+            g_hal->audio_stop();
+        }
+        g_recording = 0;
+        g_hal->led(HS_LED_PROCESSING);
+        HS_LOGI("Recording stopped, processing %u bytes", (unsigned)g_audio_len);
+
+        if (g_audio_len > 0) {
+            char response[1024] = {0};
+            int ret = send_voice_to_cloud(g_audio_buffer, g_audio_len, response, sizeof(response));
+
+            if (ret == 0 && strlen(response) > 0) {
+                g_hal->led(HS_LED_SUCCESS);
+                process_voice_response(response);
+            } else {
+                g_hal->led(HS_LED_ERROR);
+                play_tts("Sorry, I didn't understand that");
+            }
+        }
+
+        g_hal->sleep_ms(500);
+        g_hal->led(HS_LED_IDLE);
+        hs_power_hold(0);
+    }
+    else if (!g_recording && !hs_ota_busy() &&
+             g_hal->now_ms() - g_last_ota_check >= OTA_CHECK_INTERVAL_MS) {
+        g_last_ota_check = g_hal->now_ms();
+        hs_power_hold(1);
+        ota_check_for_update();
+        hs_power_hold(0);
+    }
+    else if (!g_recording &&
+             g_hal->now_ms() - g_last_reconcile >= LEDGER_RECONCILE_INTERVAL_MS) {
+        g_last_reconcile = g_hal->now_ms();
+        hs_ledger_entry_t pending;
+        if (hs_ledger_next_pending(0, &pending) == 0) {
+            hs_power_hold(1);
+            ledger_reconcile();
+            hs_power_hold(0);
+        }
+    }
+    else if (g_hal->now_ms() - g_last_metrics >= METRICS_INTERVAL_MS) {
+        g_last_metrics = g_hal->now_ms();
+        metrics_collect();
+    }
+    else if (!g_recording && g_metrics_ready &&
+             g_hal->now_ms() - g_metrics_ready_since >= METRICS_FLUSH_MS) {
+        hs_power_hold(1);
+        metrics_flush();
+        hs_power_hold(0);
+        g_metrics_ready_since = g_hal->now_ms();
+    }
+    else if (g_hal->now_ms() - g_last_power_report >= POWER_REPORT_INTERVAL_MS) {
+        g_last_power_report = g_hal->now_ms();
+        power_report();
+    }
+
+    // Firmware download, a slice per pass and paused while the merchant talks
+    if (!g_recording && !g_button_pressed && hs_ota_busy()) {
+        ota_step();
+    }
+
+    // Button events end the wait early, so a press never waits out the timeout
+    uint32_t wait = hs_power_wait_ms();
+    if (hs_ota_wait_ms() < wait) {
+        wait = hs_ota_wait_ms();
+    }
+    g_hal->wait_event(wait);
+}
+
+void hs_terminal_run(void)
+{
+    while (1) {
+        hs_terminal_step();
+    }
+}
@@ -0,0 +1,69 @@
+/**
+ * @file hs_terminal.h
+ * @brief HeySalad T5 Terminal - Terminal core
+ *
+ * Push-to-talk voice loop, payments, ledger, OTA, telemetry and power
+ * management, written against hs_hal_t only. The same code runs on the
+ * T5AI-Core (tuya_main.c) and on a Linux host (host/).
+ *
+ * Boot sequence for a backend:
+ *
+ *   hs_terminal_init(&hal);     // Flash-backed state, before any thread uses it
+ *   ...start backend threads...
+ *   if (hs_terminal_start() == 0) {
+ *       hs_terminal_run();      // Or call hs_terminal_step() from a simulator
+ *   }
+ *
+ * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
+ */
+
+#ifndef HS_TERMINAL_H
+#define HS_TERMINAL_H
+
+#include <stddef.h>
+
+#include "hs_hal.h"
+
+/**
+ * @brief Install hal, roll back a failed update, load config and ledger
+ *
+ * @return 0 on success, -1 if the partition table has no room for the
+ *         terminal data
+ */
+int hs_terminal_init(const hs_hal_t *hal);
+
+/**
+ * @brief Join WiFi and confirm the running image
+ *
+ * @return 0 when online, -1 if WiFi did not come up in time
+ */
+int hs_terminal_start(void);
+
+/**
+ * @brief One pass of the main loop, blocks in hal->wait_event() at the end
+ */
+void hs_terminal_step(void);
+
+/**
+ * @brief Main loop, never returns
+ */
+void hs_terminal_run(void);
+
+/**
+ * @brief Push-to-talk button edge, safe from interrupt context
+ */
+void hs_terminal_button(int pressed);
+
+/**
+ * @brief WiFi link change, safe from any task
+ */
+void hs_terminal_link(int up);
+
+/**
+ * @brief Handle one line from the serial console
+ *
+ * @return 0 with reply filled in, -1 if the line is not a command
+ */
+int hs_terminal_console(const char *line, char *reply, size_t len);
+
+#endif // HS_TERMINAL_H
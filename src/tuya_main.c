@@ -2,11 +2,10 @@
  * @file tuya_main.c
  * @brief HeySalad T5 Voice Terminal - Main Entry Point
  *
- * Voice-enabled payment terminal for HeySalad
- * - Push-to-talk voice commands
- * - QR code payment generation
- * - Audio feedback via TTS
- * - WiFi connectivity to HeySalad cloud
+ * TuyaOpen backend for the terminal core (hs_terminal.c) on the T5AI-Core:
+ * status LED and push-to-talk button, microphone and speaker, WiFi via
+ * netmgr, HTTP client, on-chip flash and partition table, the SDK OTA
+ * install, and the serial provisioning console.
  *
  * @copyright Copyright (c) 2025 HeySalad OÜ. All Rights Reserved.
  */
@@ -15,43 +14,39 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <strings.h>
 
 #include "tal_api.h"
 #include "tuya_config.h"
 #include "tuya_iot.h"
 #include "netmgr.h"
 #include "tkl_output.h"
+#include "tkl_flash.h"
+#include "tkl_ota.h"
+#include "tkl_audio.h"
+#include "tuya_transporter.h"
 
 #if defined(ENABLE_WIFI) && (ENABLE_WIFI == 1)
 #include "netconn_wifi.h"
+#include "tkl_wifi.h"
 #endif
 
 #include "heysalad_config.h"
+#include "hs_hal.h"
+#include "hs_flash.h"
+#include "hs_terminal.h"
 
 // Tuya device handle
 static tuya_iot_client_t heysalad_client;
 
-// State
-static volatile int g_wifi_connected = 0;
-static volatile int g_button_pressed = 0;
-static volatile int g_recording = 0;
+static THREAD_HANDLE g_led_thread = NULL;
+static volatile hs_led_t g_led_status = HS_LED_IDLE;
 
-// Audio buffer
-#define AUDIO_BUFFER_MAX (16000 * 5)  // 5 seconds at 16kHz
-static uint8_t g_audio_buffer[AUDIO_BUFFER_MAX];
-static size_t g_audio_len = 0;
+static THREAD_HANDLE g_console_thread = NULL;
 
-// LED status
-typedef enum {
-    LED_STATUS_IDLE = 0,
-    LED_STATUS_LISTENING,
-    LED_STATUS_PROCESSING,
-    LED_STATUS_SUCCESS,
-    LED_STATUS_ERROR
-} led_status_t;
-
-static THREAD_HANDLE g_led_thread = NULL;
-static led_status_t g_led_status = LED_STATUS_IDLE;
+// Power management: threads block on these instead of polling
+static SEM_HANDLE g_wake_sem = NULL;
+static SEM_HANDLE g_led_sem = NULL;
 
 /**
  * @brief Log output callback
@@ -68,34 +63,34 @@ static void led_thread_func(void *arg)
 {
     int led_state = 0;
     int blink_delay = 500;
-    
+
     while (1) {
         switch (g_led_status) {
-            case LED_STATUS_IDLE:
+            case HS_LED_IDLE:
                 tkl_gpio_write(PIN_USER_LED, TUYA_GPIO_LEVEL_LOW);
-                tal_system_sleep(100);
+                tal_semaphore_wait(g_led_sem, SEM_WAIT_FOREVER);
                 break;
-                
-            case LED_STATUS_LISTENING:
+
+            case HS_LED_LISTENING:
                 blink_delay = 300;
                 led_state = !led_state;
                 tkl_gpio_write(PIN_USER_LED, led_state ? TUYA_GPIO_LEVEL_HIGH : TUYA_GPIO_LEVEL_LOW);
                 tal_system_sleep(blink_delay);
                 break;
-                
-            case LED_STATUS_PROCESSING:
+
+            case HS_LED_PROCESSING:
                 blink_delay = 100;
                 led_state = !led_state;
                 tkl_gpio_write(PIN_USER_LED, led_state ? TUYA_GPIO_LEVEL_HIGH : TUYA_GPIO_LEVEL_LOW);
                 tal_system_sleep(blink_delay);
                 break;
-                
-            case LED_STATUS_SUCCESS:
+
+            case HS_LED_SUCCESS:
                 tkl_gpio_write(PIN_USER_LED, TUYA_GPIO_LEVEL_HIGH);
-                tal_system_sleep(100);
+                tal_semaphore_wait(g_led_sem, SEM_WAIT_FOREVER);
                 break;
-                
-            case LED_STATUS_ERROR:
+
+            case HS_LED_ERROR:
                 // Triple flash
                 for (int i = 0; i < 3; i++) {
                     tkl_gpio_write(PIN_USER_LED, TUYA_GPIO_LEVEL_HIGH);
@@ -103,7 +98,7 @@ static void led_thread_func(void *arg)
                     tkl_gpio_write(PIN_USER_LED, TUYA_GPIO_LEVEL_LOW);
                     tal_system_sleep(100);
                 }
-                g_led_status = LED_STATUS_IDLE;
+                g_led_status = HS_LED_IDLE;
                 break;
         }
     }
@@ -112,9 +107,43 @@ static void led_thread_func(void *arg)
 /**
  * @brief Set LED status
  */
-static void set_led_status(led_status_t status)
+static void set_led_status(hs_led_t status)
 {
     g_led_status = status;
+    tal_semaphore_post(g_led_sem);
+}
+
+/**
+ * @brief Serial console thread, handles provisioning commands
+ */
+static void console_thread_func(void *arg)
+{
+    char line[192];
+    char reply[512];
+    size_t len = 0;
+    uint8_t c;
+
+    while (1) {
+        if (tal_uart_read(TUYA_UART_NUM_0, &c, 1) != 1) {
+            tal_system_sleep(hs_power_wait_ms() < 50 ? 50 : hs_power_wait_ms());
+            continue;
+        }
+        if (c != '\n' && c != '\r') {
+            if (len < sizeof(line) - 1) {
+                line[len++] = (char)c;
+            }
+            continue;
+        }
+        if (len == 0) {
+            continue;
+        }
+        line[len] = '\0';
+        len = 0;
+
+        if (hs_terminal_console(line, reply, sizeof(reply)) == 0) {
+            tal_uart_write(TUYA_UART_NUM_0, (const uint8_t *)reply, strlen(reply));
+        }
+    }
 }
 
 /**
@@ -124,7 +153,29 @@ static void button_irq_cb(void *arg)
 {
     TUYA_GPIO_LEVEL_E level;
     tkl_gpio_read(PIN_USER_BUTTON, &level);
-    g_button_pressed = (level == TUYA_GPIO_LEVEL_LOW);  // Active low
+    hs_terminal_button(level == TUYA_GPIO_LEVEL_LOW);  // Active low
+    tal_semaphore_post(g_wake_sem);
+}
+
+/**
+ * @brief WiFi event callback
+ */
+static void wifi_event_cb(NETMGR_STATUS_E status)
+{
+    switch (status) {
+        case NETMGR_LINK_UP:
+            hs_terminal_link(1);
+            tal_semaphore_post(g_wake_sem);
+            break;
+
+        case NETMGR_LINK_DOWN:
+            hs_terminal_link(0);
+            tal_semaphore_post(g_wake_sem);
+            break;
+
+        default:
+            break;
+    }
 }
 
 /**
@@ -139,7 +190,7 @@ static void gpio_init(void)
         .level = TUYA_GPIO_LEVEL_LOW,
     };
     tkl_gpio_init(PIN_USER_LED, &led_cfg);
-    
+
     // Button input with interrupt
     TUYA_GPIO_BASE_CFG_T btn_cfg = {
         .mode = TUYA_GPIO_PULLUP,
@@ -147,7 +198,7 @@ static void gpio_init(void)
         .level = TUYA_GPIO_LEVEL_HIGH,
     };
     tkl_gpio_init(PIN_USER_BUTTON, &btn_cfg);
-    
+
     TUYA_GPIO_IRQ_T irq_cfg = {
         .mode = TUYA_GPIO_IRQ_BOTH,
         .cb = button_irq_cb,
@@ -157,186 +208,656 @@ static void gpio_init(void)
     tkl_gpio_irq_enable(PIN_USER_BUTTON);
 }
 
+// ============================================
+// HAL backend
+// ============================================
+
+static uint32_t hal_now_ms(void)
+{
+    return tal_system_get_millisecond();
+}
+
+static uint32_t hal_time_s(void)
+{
+    return (uint32_t)tal_time_get_posix();
+}
+
+static void hal_sleep_ms(uint32_t ms)
+{
+    tal_system_sleep(ms);
+}
+
+static void hal_wait_event(uint32_t ms)
+{
+    // Button IRQ posts the semaphore
+    tal_semaphore_wait(g_wake_sem, ms);
+}
+
+/**
+ * @brief Apply CPU and WiFi power settings for a power state
+ */
+static void hal_power(hs_power_state_t state)
+{
+    switch (state) {
+        case HS_POWER_ACTIVE:
+            tal_cpu_sleep_mode_set(FALSE, TUYA_CPU_SLEEP);
+#if defined(ENABLE_WIFI) && (ENABLE_WIFI == 1)
+            tkl_wifi_set_lp_mode(FALSE, 0);
+#endif
+            break;
+
+        case HS_POWER_IDLE:
+            tal_cpu_sleep_mode_set(TRUE, TUYA_CPU_SLEEP);
+#if defined(ENABLE_WIFI) && (ENABLE_WIFI == 1)
+            tkl_wifi_set_lp_mode(TRUE, POWER_DTIM_IDLE);
+#endif
+            break;
+
+        case HS_POWER_SLEEP:
+            // Same CPU sleep as IDLE so the button IRQ and beacons still wake
+            // it; only the listen interval (and the loop tick) stretch
+            tal_cpu_sleep_mode_set(TRUE, TUYA_CPU_SLEEP);
+#if defined(ENABLE_WIFI) && (ENABLE_WIFI == 1)
+            tkl_wifi_set_lp_mode(TRUE, POWER_DTIM_SLEEP);
+#endif
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void hal_reset(void)
+{
+    tal_system_reset();
+}
+
+static int hal_net_connect(const char *ssid, const char *pass)
+{
+#if defined(ENABLE_WIFI) && (ENABLE_WIFI == 1)
+    netmgr_conn_set(NETCONN_WIFI, wifi_event_cb);
+
+    NETCONN_WIFI_CFG_T wifi_cfg = {
+        .ssid = (char *)ssid,
+        .pswd = (char *)pass,
+    };
+    netmgr_conn_config(NETCONN_WIFI, &wifi_cfg);
+    netmgr_conn_start(NETCONN_WIFI);
+    return 0;
+#else
+    return -1;
+#endif
+}
+
 /**
  * @brief HTTP POST request helper
  */
-static int http_post(const char *url, const char *content_type, 
-                     const uint8_t *body, size_t body_len,
-                     char *response, size_t response_max)
+static int hal_http_post(const char *url, const char *content_type, const char *const *headers,
+                         const uint8_t *body, size_t body_len,
+                         uint8_t *resp, size_t resp_max, size_t *resp_len)
 {
     // Use Tuya HTTP client
     HTTP_HANDLE_T http = NULL;
     int ret = -1;
-    
+
+    *resp_len = 0;
     http = http_client_create();
     if (!http) {
         PR_ERR("Failed to create HTTP client");
         return -1;
     }
-    
+
     http_client_set_url(http, url);
     http_client_set_method(http, HTTP_POST);
     http_client_set_header(http, "Content-Type", content_type);
+    for (int i = 0; headers && headers[i]; i += 2) {
+        http_client_set_header(http, headers[i], headers[i + 1]);
+    }
     http_client_set_body(http, (char *)body, body_len);
-    
+
     ret = http_client_execute(http);
     if (ret == 0) {
         char *resp_body = NULL;
-        size_t resp_len = 0;
-        http_client_get_response_body(http, &resp_body, &resp_len);
-        if (resp_body && resp_len > 0 && response) {
-            size_t copy_len = resp_len < response_max - 1 ? resp_len : response_max - 1;
-            memcpy(response, resp_body, copy_len);
-            response[copy_len] = '\0';
+        size_t len = 0;
+        http_client_get_response_body(http, &resp_body, &len);
+        if (resp_body && len > 0 && resp) {
+            memcpy(resp, resp_body, len < resp_max ? len : resp_max);
         }
+        *resp_len = len;
     }
-    
+
     http_client_destroy(http);
     return ret;
 }
 
-/**
- * @brief Send voice to HeySalad cloud
- */
-static int send_voice_to_cloud(const uint8_t *audio, size_t len, char *response, size_t response_len)
-{
+// ============================================
+// Download stream
+// The request and every blocking read run on their own thread, so a
+// stalled link never holds up the main loop; it only ever copies what
+// has arrived out of the ring.
+// ============================================
+
+#define HTTP_GET_HEAD_MAX   512
+#define HTTP_GET_TIMEOUT_MS 10000
+#define HTTP_GET_RING       4096        // Power of two
+#define HTTP_GET_CHUNK      1024
+
+typedef enum {
+    GET_FREE = 0,
+    GET_CONNECTING,
+    GET_BODY,
+    GET_ENDED,                  // Failed, timed out or closed by the server
+} get_state_t;
+
+// Single in-flight GET, shared by the main loop and the download thread
+typedef struct {
+    int state;
+    int cancel;                 // Closed by the main loop, the thread cleans up
     char url[256];
-    snprintf(url, sizeof(url), "%s/api/voice/chat", HEYSALAD_TUYA_BRIDGE);
-    
-    return http_post(url, "audio/wav", audio, len, response, response_len);
-}
+    uint32_t offset;
+    hs_http_head_t head;
+    uint32_t wr;                // Free running, advanced by the thread only
+    uint32_t rd;                // Free running, advanced by the main loop only
+    uint8_t ring[HTTP_GET_RING];
+} get_stream_t;
+
+static get_stream_t g_get;
+static THREAD_HANDLE g_get_thread = NULL;
+static SEM_HANDLE g_get_sem = NULL;
 
 /**
- * @brief Create payment via HeySalad API
+ * @brief Read one response head line, without the CRLF
  */
-static int create_payment(float amount, const char *currency, char *qr_url, size_t url_len)
+static int http_read_line(tuya_transporter_t conn, char *line, size_t max)
 {
-    char url[256];
-    snprintf(url, sizeof(url), "%s/api/payment/create", HEYSALAD_TUYA_BRIDGE);
-    
-    char body[256];
-    snprintf(body, sizeof(body), 
-        "{\"amount\":%.2f,\"currency\":\"%s\",\"device_id\":\"%s\"}",
-        amount, currency, TUYA_DEVICE_ID);
-    
-    char response[1024] = {0};
-    int ret = http_post(url, "application/json", (uint8_t *)body, strlen(body), response, sizeof(response));
-    
-    if (ret == 0 && strlen(response) > 0) {
-        // Parse QR URL from response
-        char *qr_start = strstr(response, "\"qr_url\":\"");
-        if (qr_start) {
-            qr_start += 10;
-            char *qr_end = strchr(qr_start, '"');
-            if (qr_end) {
-                size_t len = qr_end - qr_start;
-                if (len < url_len) {
-                    strncpy(qr_url, qr_start, len);
-                    qr_url[len] = '\0';
-                    return 0;
-                }
+    size_t len = 0;
+    uint8_t c;
+
+    while (tuya_transporter_read(conn, &c, 1, HTTP_GET_TIMEOUT_MS) == 1) {
+        if (c == '\n') {
+            if (len > 0 && line[len - 1] == '\r') {
+                len--;
             }
+            line[len] = '\0';
+            return 0;
+        }
+        if (len < max - 1) {
+            line[len++] = (char)c;
         }
     }
-    
     return -1;
 }
 
 /**
- * @brief Play TTS audio
+ * @brief Connect, send the request and read the response head
+ *
+ * Speaks HTTP/1.0 over a single connection, so the body is never chunked
+ * and ends when the server closes.
+ *
+ * @return Connection positioned at the body, NULL on failure
  */
-static void play_tts(const char *text)
+static tuya_transporter_t http_get_request(const char *url, uint32_t offset, hs_http_head_t *head)
 {
-    PR_INFO("TTS: %s", text);
-    
-    char url[256];
-    snprintf(url, sizeof(url), "%s/api/voice/speak", HEYSALAD_VOICE_AGENT);
-    
-    char body[512];
-    snprintf(body, sizeof(body), "{\"text\":\"%s\"}", text);
-    
-    // TODO: Implement audio playback
-    // For now, just log
+    tuya_transporter_t conn = NULL;
+    char host[128];
+    char line[HTTP_GET_HEAD_MAX];
+    const char *p = NULL;
+    int tls = 0, port = 0, n = 0;
+
+    if (strncmp(url, "https://", 8) == 0) {
+        tls = 1;
+        port = 443;
+        p = url + 8;
+    } else if (strncmp(url, "http://", 7) == 0) {
+        port = 80;
+        p = url + 7;
+    } else {
+        return NULL;
+    }
+
+    const char *path = strchr(p, '/');
+    size_t host_len = path ? (size_t)(path - p) : strlen(p);
+    if (host_len >= sizeof(host)) {
+        return NULL;
+    }
+    memcpy(host, p, host_len);
+    host[host_len] = '\0';
+    char *colon = strchr(host, ':');
+    if (colon) {
+        *colon = '\0';
+        port = atoi(colon + 1);
+    }
+
+    conn = tuya_transporter_create(tls ? TRANSPORT_TYPE_TLS : TRANSPORT_TYPE_TCP, NULL);
+    if (!conn) {
+        PR_ERR("Failed to create HTTP connection");
+        return NULL;
+    }
+    if (tuya_transporter_connect(conn, host, port, HTTP_GET_TIMEOUT_MS) != OPRT_OK) {
+        goto fail;
+    }
+
+    n = snprintf(line, sizeof(line), "GET %s HTTP/1.0\r\nHost: %s\r\n", path ? path : "/", host);
+    if (offset > 0) {
+        n += snprintf(line + n, sizeof(line) - n, "Range: bytes=%u-\r\n", (unsigned)offset);
+    }
+    n += snprintf(line + n, sizeof(line) - n, "\r\n");
+    if (n >= (int)sizeof(line) ||
+        tuya_transporter_write(conn, (uint8_t *)line, n, HTTP_GET_TIMEOUT_MS) != n) {
+        goto fail;
+    }
+
+    // Status line, then headers up to the blank line
+    memset(head, 0, sizeof(*head));
+    if (http_read_line(conn, line, sizeof(line)) != 0 ||
+        sscanf(line, "HTTP/%*s %d", &head->status) != 1) {
+        goto fail;
+    }
+    while (http_read_line(conn, line, sizeof(line)) == 0) {
+        if (line[0] == '\0') {
+            return conn;
+        }
+        if (strncasecmp(line, "Content-Range:", 14) == 0) {
+            p = line + 14;
+            while (*p == ' ') {
+                p++;
+            }
+            if (strncmp(p, "bytes ", 6) == 0 && p[6] >= '0' && p[6] <= '9') {
+                head->range_start = (uint32_t)strtoul(p + 6, NULL, 10);
+                head->has_range = 1;
+            }
+        }
+    }
+
+fail:
+    head->status = 0;
+    tuya_transporter_close(conn);
+    tuya_transporter_destroy(conn);
+    return NULL;
 }
 
 /**
- * @brief Process voice response
+ * @brief Download thread, runs one GET at a time into the ring
  */
-static void process_voice_response(const char *response)
-{
-    PR_INFO("Processing response: %s", response);
-    
-    // Check for payment action
-    if (strstr(response, "\"action\":\"payment\"") != NULL) {
-        char *amount_str = strstr(response, "\"amount\":");
-        if (amount_str) {
-            float amount = atof(amount_str + 9);
-            
-            char qr_url[256] = {0};
-            if (create_payment(amount, DEFAULT_CURRENCY, qr_url, sizeof(qr_url)) == 0) {
-                PR_INFO("Payment QR: %s", qr_url);
-                set_led_status(LED_STATUS_SUCCESS);
-                play_tts("Payment created. Customer can scan the QR code.");
-            } else {
-                set_led_status(LED_STATUS_ERROR);
-                play_tts("Failed to create payment");
+static void get_thread_func(void *arg)
+{
+    static uint8_t chunk[HTTP_GET_CHUNK];
+    hs_http_head_t head;
+
+    while (1) {
+        tal_semaphore_wait(g_get_sem, SEM_WAIT_FOREVER);
+        if (__atomic_load_n(&g_get.state, __ATOMIC_ACQUIRE) != GET_CONNECTING) {
+            continue;
+        }
+
+        tuya_transporter_t conn = http_get_request(g_get.url, g_get.offset, &head);
+        g_get.head = head;
+        __atomic_store_n(&g_get.state, conn ? GET_BODY : GET_ENDED, __ATOMIC_RELEASE);
+        tal_semaphore_post(g_wake_sem);
+
+        while (conn && !__atomic_load_n(&g_get.cancel, __ATOMIC_ACQUIRE)) {
+            uint32_t room = HTTP_GET_RING - (g_get.wr - __atomic_load_n(&g_get.rd, __ATOMIC_ACQUIRE));
+
+            if (room == 0) {
+                // The main loop is busy with the merchant, let it catch up
+                tal_system_sleep(20);
+                continue;
+            }
+            // A timeout and a close both read 0, either way this body is over
+            int n = tuya_transporter_read(conn, chunk, room < sizeof(chunk) ? room : sizeof(chunk),
+                                          HTTP_GET_TIMEOUT_MS);
+            if (n <= 0) {
+                break;
             }
+            for (int i = 0; i < n; i++) {
+                g_get.ring[(g_get.wr + i) & (HTTP_GET_RING - 1)] = chunk[i];
+            }
+            __atomic_store_n(&g_get.wr, g_get.wr + n, __ATOMIC_RELEASE);
+            tal_semaphore_post(g_wake_sem);
+        }
+        if (conn) {
+            tuya_transporter_close(conn);
+            tuya_transporter_destroy(conn);
         }
+        __atomic_store_n(&g_get.state, GET_ENDED, __ATOMIC_RELEASE);
+        tal_semaphore_post(g_wake_sem);
+
+        // Hold the slot until the main loop lets go of the stream
+        while (!__atomic_load_n(&g_get.cancel, __ATOMIC_ACQUIRE)) {
+            tal_semaphore_wait(g_get_sem, SEM_WAIT_FOREVER);
+        }
+        __atomic_store_n(&g_get.state, GET_FREE, __ATOMIC_RELEASE);
     }
-    // Check for text response
-    else if (strstr(response, "\"text\":") != NULL) {
-        char *text_start = strstr(response, "\"text\":\"");
-        if (text_start) {
-            text_start += 8;
-            char *text_end = strchr(text_start, '"');
-            if (text_end) {
-                size_t len = text_end - text_start;
-                char text[512] = {0};
-                if (len < sizeof(text) - 1) {
-                    strncpy(text, text_start, len);
-                    play_tts(text);
-                }
-            }
+}
+
+/**
+ * @brief Start a GET on the download thread, NULL while the last one is
+ *        still winding down
+ */
+static void *hal_http_get_open(const char *url, uint32_t offset)
+{
+    if (__atomic_load_n(&g_get.state, __ATOMIC_ACQUIRE) != GET_FREE ||
+        strlen(url) >= sizeof(g_get.url)) {
+        return NULL;
+    }
+    strcpy(g_get.url, url);
+    g_get.offset = offset;
+    g_get.wr = 0;
+    g_get.rd = 0;
+    g_get.cancel = 0;
+    __atomic_store_n(&g_get.state, GET_CONNECTING, __ATOMIC_RELEASE);
+    tal_semaphore_post(g_get_sem);
+    return &g_get;
+}
+
+static int hal_http_get_head(void *stream, hs_http_head_t *head)
+{
+    get_stream_t *st = stream;
+    int state = __atomic_load_n(&st->state, __ATOMIC_ACQUIRE);
+
+    if (state == GET_CONNECTING) {
+        return 1;
+    }
+    if (st->head.status == 0) {
+        return -1;
+    }
+    *head = st->head;
+    return 0;
+}
+
+static int hal_http_get_read(void *stream, uint8_t *buf, size_t len, size_t *got)
+{
+    get_stream_t *st = stream;
+    // State first: once ENDED is seen, wr is final
+    int state = __atomic_load_n(&st->state, __ATOMIC_ACQUIRE);
+    uint32_t avail = __atomic_load_n(&st->wr, __ATOMIC_ACQUIRE) - st->rd;
+
+    *got = 0;
+    if (avail == 0) {
+        return state == GET_ENDED ? -1 : 0;
+    }
+    if (avail > len) {
+        avail = (uint32_t)len;
+    }
+    for (uint32_t i = 0; i < avail; i++) {
+        buf[i] = st->ring[(st->rd + i) & (HTTP_GET_RING - 1)];
+    }
+    __atomic_store_n(&st->rd, st->rd + avail, __ATOMIC_RELEASE);
+    *got = avail;
+    return 0;
+}
+
+/**
+ * @brief Never blocks; the thread drops the connection after its current read
+ */
+static void hal_http_get_close(void *stream)
+{
+    __atomic_store_n(&((get_stream_t *)stream)->cancel, 1, __ATOMIC_RELEASE);
+    tal_semaphore_post(g_get_sem);
+}
+
+// ============================================
+// Audio
+// The driver hands microphone frames to a callback on its own task; they
+// go through a ring the main loop drains every pass while recording.
+// ============================================
+
+#define AUDIO_RING          16384       // Power of two, ~0.5 s of 16 kHz PCM
+
+static struct {
+    volatile int on;            // Frames kept only while recording
+    volatile uint32_t wr;       // Free running, written by the driver task
+    volatile uint32_t rd;       // Free running, written by the main loop
+    uint8_t ring[AUDIO_RING];
+} g_mic;
+
+/**
+ * @brief Driver callback, one PCM frame every few ms
+ */
+static int audio_frame_put(TKL_AUDIO_FRAME_INFO_T *frame)
+{
+    uint32_t room = AUDIO_RING - (g_mic.wr - __atomic_load_n(&g_mic.rd, __ATOMIC_ACQUIRE));
+    uint32_t n = frame->used_size;
+
+    if (!__atomic_load_n(&g_mic.on, __ATOMIC_ACQUIRE)) {
+        return 0;
+    }
+    // A main loop that fell behind loses the newest audio, counted as an overrun there
+    if (n > room) {
+        n = room;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        g_mic.ring[(g_mic.wr + i) & (AUDIO_RING - 1)] = (uint8_t)frame->pbuf[i];
+    }
+    __atomic_store_n(&g_mic.wr, g_mic.wr + n, __ATOMIC_RELEASE);
+    return 0;
+}
+
+static int audio_init(void)
+{
+    TKL_AUDIO_CONFIG_T config;
+
+    memset(&config, 0, sizeof(config));
+    config.enable = 0;
+    config.card = TKL_AUDIO_TYPE_BOARD;
+    config.ai_chn = TKL_AI_0;
+    config.sample = TKL_AUDIO_SAMPLE_16K;
+    config.spk_sample = TKL_AUDIO_SAMPLE_16K;
+    config.datebits = TKL_AUDIO_DATABITS_16;
+    config.channel = TKL_AUDIO_CHANNEL_MONO;
+    config.codectype = TKL_CODEC_AUDIO_PCM;
+    config.put_cb = audio_frame_put;
+    config.spk_gpio = PIN_SPEAKER_EN;
+    config.spk_gpio_polarity = 0;
+
+    if (tkl_ai_init(&config, 0) != OPRT_OK || tkl_ai_start(0, TKL_AI_0) != OPRT_OK) {
+        PR_ERR("Audio init failed");
+        return -1;
+    }
+    tkl_ai_set_vol(TKL_AUDIO_TYPE_BOARD, TKL_AI_0, AUDIO_MIC_VOLUME);
+    tkl_ao_set_vol(TKL_AUDIO_TYPE_BOARD, TKL_AO_0, NULL, AUDIO_SPK_VOLUME);
+    return 0;
+}
+
+/**
+ * @brief Start keeping microphone frames, anything older is dropped
+ */
+static int hal_audio_start(void)
+{
+    __atomic_store_n(&g_mic.rd, __atomic_load_n(&g_mic.wr, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+    __atomic_store_n(&g_mic.on, 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+static size_t hal_audio_read(uint8_t *buf, size_t len)
+{
+    uint32_t avail = __atomic_load_n(&g_mic.wr, __ATOMIC_ACQUIRE) - g_mic.rd;
+
+    if (avail > len) {
+        avail = (uint32_t)len;
+    }
+    for (uint32_t i = 0; i < avail; i++) {
+        buf[i] = g_mic.ring[(g_mic.rd + i) & (AUDIO_RING - 1)];
+    }
+    __atomic_store_n(&g_mic.rd, g_mic.rd + avail, __ATOMIC_RELEASE);
+    return avail;
+}
+
+/**
+ * @brief Stop keeping frames; what is already in the ring can still be read
+ */
+static void hal_audio_stop(void)
+{
+    __atomic_store_n(&g_mic.on, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Play 16 kHz mono PCM, a frame at a time as the driver takes it
+ */
+static void hal_audio_play(const uint8_t *pcm, size_t len)
+{
+    for (size_t off = 0; off < len; off += AUDIO_BUFFER_SIZE) {
+        TKL_AUDIO_FRAME_INFO_T frame;
+
+        memset(&frame, 0, sizeof(frame));
+        frame.type = TKL_AUDIO_FRAME;
+        frame.pbuf = (char *)(pcm + off);
+        frame.used_size = len - off < AUDIO_BUFFER_SIZE ? len - off : AUDIO_BUFFER_SIZE;
+        if (tkl_ao_put_frame(0, TKL_AO_0, NULL, &frame) != OPRT_OK) {
+            PR_ERR("Audio playback failed");
+            return;
         }
     }
 }
 
+static int flash_read(void *ctx, uint32_t addr, uint8_t *buf, size_t len)
+{
+    (void)ctx;
+    return tkl_flash_read(addr, buf, len) == OPRT_OK ? 0 : -1;
+}
+
+static int flash_write(void *ctx, uint32_t addr, const uint8_t *buf, size_t len)
+{
+    (void)ctx;
+    return tkl_flash_write(addr, buf, len) == OPRT_OK ? 0 : -1;
+}
+
+static int flash_erase(void *ctx, uint32_t addr, size_t len)
+{
+    (void)ctx;
+    return tkl_flash_erase(addr, len) == OPRT_OK ? 0 : -1;
+}
+
+static const hs_flash_ops_t g_flash_ops = {
+    .read = flash_read,
+    .write = flash_write,
+    .erase = flash_erase,
+};
+
+/**
+ * @brief Terminal partitions, as laid out by the SDK partition table
+ */
+static int hal_partition(hs_part_t part, uint32_t *base, uint32_t *size)
+{
+    static const TUYA_FLASH_TYPE_E types[HS_PART_MAX] = {
+        [HS_PART_APP] = TUYA_FLASH_TYPE_APP,
+        [HS_PART_OTA] = TUYA_FLASH_TYPE_USER1,     // Package slots, the SDK owns TYPE_OTA
+        [HS_PART_DATA] = TUYA_FLASH_TYPE_USER0,
+    };
+    TUYA_FLASH_BASE_INFO_T info;
+
+    if (part >= HS_PART_MAX || tkl_flash_get_one_type_info(types[part], &info) != OPRT_OK ||
+        info.partition_num == 0) {
+        return -1;
+    }
+    *base = info.partition[0].start_addr;
+    *size = info.partition[0].size;
+    return 0;
+}
+
 /**
- * @brief WiFi event callback
+ * @brief Feed a package through the SDK OTA data path
+ *
+ * data_process writes it into the SDK download partition in whatever form
+ * the bootloader expects, end_notify checks it and sets the upgrade flag;
+ * the bootloader installs it over the application on the next reset.
  */
-static void wifi_event_cb(NETMGR_STATUS_E status)
+static int hal_ota_install(const hs_flash_region_t *pkg, uint32_t size)
 {
-    switch (status) {
-        case NETMGR_LINK_UP:
-            PR_INFO("WiFi connected!");
-            g_wifi_connected = 1;
-            set_led_status(LED_STATUS_SUCCESS);
+    static uint8_t buf[1024];
+    uint32_t off = 0;
+
+    if (tkl_ota_start_notify(size, TUYA_OTA_FULL, TUYA_OTA_PATH_AIR) != OPRT_OK) {
+        return -1;
+    }
+    while (off < size) {
+        uint32_t n = size - off < sizeof(buf) ? size - off : sizeof(buf);
+        UINT_T remain = 0;
+        TUYA_OTA_DATA_T pack = {
+            .total_len = size,
+            .offset = off,
+            .data = buf,
+            .len = n,
+            .pri_data = NULL,
+        };
+
+        if (hs_flash_read(pkg, off, buf, n) != 0 || tkl_ota_data_process(&pack, &remain) != OPRT_OK ||
+            remain >= n) {
+            return -1;
+        }
+        // Bytes the SDK left over come again at the front of the next pack
+        off += n - remain;
+    }
+    return tkl_ota_end_notify(FALSE) == OPRT_OK ? 0 : -1;
+}
+
+static void hal_log(hs_log_level_t level, const char *line)
+{
+    switch (level) {
+        case HS_LOG_ERR:
+            PR_ERR("%s", line);
             break;
-            
-        case NETMGR_LINK_DOWN:
-            PR_INFO("WiFi disconnected");
-            g_wifi_connected = 0;
-            set_led_status(LED_STATUS_ERROR);
+        case HS_LOG_INFO:
+            PR_INFO("%s", line);
             break;
-            
         default:
+            PR_DEBUG("%s", line);
             break;
     }
 }
 
+static uint32_t hal_free_heap(void)
+{
+    return (uint32_t)tal_system_get_free_heap_size();
+}
+
+static const hs_hal_t g_hal = {
+    .led = set_led_status,
+    .now_ms = hal_now_ms,
+    .time_s = hal_time_s,
+    .sleep_ms = hal_sleep_ms,
+    .wait_event = hal_wait_event,
+    .power = hal_power,
+    .reset = hal_reset,
+    .audio_start = hal_audio_start,
+    .audio_read = hal_audio_read,
+    .audio_stop = hal_audio_stop,
+    .audio_play = hal_audio_play,
+    .net_connect = hal_net_connect,
+    .http_post = hal_http_post,
+    .http_get_open = hal_http_get_open,
+    .http_get_head = hal_http_get_head,
+    .http_get_read = hal_http_get_read,
+    .http_get_close = hal_http_get_close,
+    .flash = &g_flash_ops,
+    .flash_ctx = NULL,
+    .partition = hal_partition,
+    .ota_install = hal_ota_install,
+    .log = hal_log,
+    .free_heap = hal_free_heap,
+};
+
 /**
  * @brief Main entry point
  */
 void tuya_app_main(void)
 {
-    PR_INFO("========================================");
-    PR_INFO("HeySalad T5 Voice Terminal v1.0");
-    PR_INFO("Device ID: %s", TUYA_DEVICE_ID);
-    PR_INFO("========================================");
-    
+    // Flash-backed state first, the console thread edits the config
+    if (hs_terminal_init(&g_hal) != 0) {
+        PR_ERR("Terminal init failed, check the partition table");
+        return;
+    }
+
+    tal_semaphore_create_init(&g_wake_sem, 0, 1);
+    tal_semaphore_create_init(&g_led_sem, 0, 1);
+    tal_semaphore_create_init(&g_get_sem, 0, 1);
+
     // Initialize GPIO
     gpio_init();
-    
+
+    // Without audio the rest of the terminal still runs
+    audio_init();
+
     // Start LED thread
     THREAD_CFG_T led_thread_cfg = {
         .priority = THREAD_PRIO_2,
@@ -344,74 +865,25 @@ void tuya_app_main(void)
         .thrdname = "led_ctrl",
     };
     tal_thread_create_and_start(&g_led_thread, NULL, NULL, led_thread_func, NULL, &led_thread_cfg);
-    
-    set_led_status(LED_STATUS_PROCESSING);
-    
-    // Connect to WiFi
-    PR_INFO("Connecting to WiFi: %s", WIFI_SSID);
-    
-#if defined(ENABLE_WIFI) && (ENABLE_WIFI == 1)
-    netmgr_conn_set(NETCONN_WIFI, wifi_event_cb);
-    
-    NETCONN_WIFI_CFG_T wifi_cfg = {
-        .ssid = WIFI_SSID,
-        .pswd = WIFI_PASS,
+
+    // Start provisioning console, usable even when WiFi fails
+    THREAD_CFG_T console_thread_cfg = {
+        .priority = THREAD_PRIO_3,
+        .stackDepth = 2048,
+        .thrdname = "console",
     };
-    netmgr_conn_config(NETCONN_WIFI, &wifi_cfg);
-    netmgr_conn_start(NETCONN_WIFI);
-#endif
-    
-    // Wait for WiFi
-    int timeout = WIFI_CONNECT_TIMEOUT_MS / 100;
-    while (!g_wifi_connected && timeout > 0) {
-        tal_system_sleep(100);
-        timeout--;
-    }
-    
-    if (!g_wifi_connected) {
-        PR_ERR("WiFi connection failed!");
-        set_led_status(LED_STATUS_ERROR);
+    tal_thread_create_and_start(&g_console_thread, NULL, NULL, console_thread_func, NULL, &console_thread_cfg);
+
+    // Firmware downloads, TLS needs the larger stack
+    THREAD_CFG_T get_thread_cfg = {
+        .priority = THREAD_PRIO_3,
+        .stackDepth = 6144,
+        .thrdname = "http_get",
+    };
+    tal_thread_create_and_start(&g_get_thread, NULL, NULL, get_thread_func, NULL, &get_thread_cfg);
+
+    if (hs_terminal_start() != 0) {
         return;
     }
-    
-    set_led_status(LED_STATUS_IDLE);
-    play_tts("HeySalad terminal ready");
-    
-    // Main loop
-    PR_INFO("Entering main loop - press button to speak");
-    
-    while (1) {
-        if (g_button_pressed && !g_recording) {
-            // Start recording
-            g_recording = 1;
-            g_audio_len = 0;
-            set_led_status(LED_STATUS_LISTENING);
-            PR_INFO("Recording started...");
-            // TODO: Start audio capture
-        }
-        else if (!g_button_pressed && g_recording) {
-            // Stop recording and process
-            g_recording = 0;
-            set_led_status(LED_STATUS_PROCESSING);
-            PR_INFO("Recording stopped, processing %zu bytes", g_audio_len);
-            
-            if (g_audio_len > 0) {
-                char response[1024] = {0};
-                int ret = send_voice_to_cloud(g_audio_buffer, g_audio_len, response, sizeof(response));
-                
-                if (ret == 0 && strlen(response) > 0) {
-                    set_led_status(LED_STATUS_SUCCESS);
-                    process_voice_response(response);
-                } else {
-                    set_led_status(LED_STATUS_ERROR);
-                    play_tts("Sorry, I didn't understand that");
-                }
-            }
-            
-            tal_system_sleep(500);
-            set_led_status(LED_STATUS_IDLE);
-        }
-        
-        tal_system_sleep(10);
-    }
+    hs_terminal_run();
 }